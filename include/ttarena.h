@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTARENA_H__
+#define __TTARENA_H__
+#include <stddef.h>
+#include <stdint.h>
+
+// Default size of the blocks an arena takes from the heap. Larger allocations get a block of their own.
+#define TTARENA_BLOCKSZ ((size_t) 1 << 20)
+
+typedef struct TTArenaBlock TTArenaBlock_t;
+
+// A bump allocator for the scratch and output buffers of one job at a time. Allocations are never freed on their own;
+// TTArena_Reset drops all of them at once between jobs and keeps the memory, so a worker running job after job stops
+// going to the heap once its arena has grown to fit its largest job. Not thread safe, an arena belongs to one worker.
+typedef struct TTArena {
+    TTArenaBlock_t *blocks;
+    size_t blockSize;
+    // Bytes handed out since the last reset and the most handed out between any two resets
+    size_t used;
+    size_t peak;
+    // Allocations served and blocks taken from the heap to serve them, over the arena's whole life
+    uint64_t allocs;
+    uint64_t heapAllocs;
+} TTArena_t;
+
+// A blockSize of 0 means TTARENA_BLOCKSZ. No memory is taken until the first allocation.
+void TTArena_Init(TTArena_t *arena, size_t blockSize);
+
+// Returns size bytes aligned for any type, or NULL if a new block was needed and could not be allocated.
+void *TTArena_Alloc(TTArena_t *arena, size_t size);
+
+// Drops every allocation. If the last job needed more than one block they are merged into a single block large enough
+// for all of it, so a job like it next time is served from one block.
+void TTArena_Reset(TTArena_t *arena);
+
+// Gives all of the arena's memory back to the heap. The arena stays usable and starts over as if just initialized,
+// apart from its counters.
+void TTArena_Free(TTArena_t *arena);
+#endif
@@ -0,0 +1,53 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTBENCH_H__
+#define __TTBENCH_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Summary of a set of timings in nanoseconds.
+typedef struct TTBenchStats {
+    uint64_t total;
+    uint64_t mean;
+    uint64_t min;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t max;
+} TTBenchStats_t;
+
+// Monotonic time in nanoseconds.
+uint64_t TTBench_Now(void);
+
+// Summarizes count samples. The samples are sorted in place.
+void TTBench_Summarize(uint64_t *samples, size_t count, TTBenchStats_t *stats);
+
+// Whether heap allocations are being counted, which takes building with TXTRTOOL_BENCH_ALLOCS (it wraps malloc, calloc
+// and realloc at link time so allocations inside the libraries are seen too).
+bool TTBench_CountsAllocs(void);
+
+// Number of heap allocations made so far by every thread (always 0 if they aren't being counted).
+uint64_t TTBench_Allocs(void);
+#endif
@@ -0,0 +1,67 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTCACHE_H__
+#define __TTCACHE_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// Identifies a cache entry: a hash of the input's content and a hash of everything else that affects the output.
+typedef struct TTCacheKey {
+    uint64_t content;
+    uint64_t options;
+} TTCacheKey_t;
+
+// An on disk, content addressed store of output files. Entries are evicted least recently used first (going by their
+// modification time, which a hit refreshes) once the total size goes over limit. Safe to share between threads.
+typedef struct TTCache {
+    pthread_mutex_t lock;
+    char *dir;
+    uint64_t limit;
+    uint64_t size;
+    size_t hits;
+    size_t misses;
+    size_t stores;
+    size_t evictions;
+    size_t tmpCounter;
+} TTCache_t;
+
+// A fast non cryptographic 64 bit hash (XXH64) for building keys.
+uint64_t TTCache_Hash(const void *data, size_t size, uint64_t seed);
+
+// Opens (creating if needed) the cache in dir. A limit of 0 means unlimited. Returns 0 on success or an errno value on
+// failure.
+int TTCache_Open(TTCache_t *cache, char *dir, uint64_t limit);
+
+void TTCache_Close(TTCache_t *cache);
+
+// Puts a copy (a reflink where the file system supports it) of the entry for key at output. Returns true on a hit.
+bool TTCache_Fetch(TTCache_t *cache, TTCacheKey_t key, char *output);
+
+// Stores a copy of the file at input as the entry for key and evicts old entries if that goes over the limit. Returns
+// 0 on success or an errno value on failure.
+int TTCache_Store(TTCache_t *cache, TTCacheKey_t key, char *input);
+#endif
@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTDDS_H__
+#define __TTDDS_H__
+#include <stddef.h>
+#include <stdint.h>
+
+// Size of the "DDS " magic and the header following it, and of the DX10 header some files add after that
+#define TTDDS_HDRSZ 128
+#define TTDDS_DX10HDRSZ 20
+
+typedef enum TTDDSError {
+    TTDDS_E_SUCCESS,
+    TTDDS_E_TRUNCATED,
+    TTDDS_E_NOTDDS,
+    TTDDS_E_NOTBC1,
+    TTDDS_E_NOT2D,
+    TTDDS_E_INVLDSIZE
+} TTDDSError_t;
+
+// A BC1 DDS's dimensions, the number of mipmaps it holds and where the first one's blocks start
+typedef struct TTDDS {
+    uint16_t width;
+    uint16_t height;
+    uint32_t mipCount;
+    size_t dataOffset;
+} TTDDS_t;
+
+char *TTDDSError_ToStr(TTDDSError_t e);
+
+// Size of a width x height BC1 image: one 8 byte block per 4x4 pixels, rows of blocks top to bottom.
+size_t TTDDS_BC1Size(uint16_t width, uint16_t height);
+
+// Writes the header of a BC1 (DXT1) DDS whose first mipmap is width x height and that holds mipCount mipmaps.
+void TTDDS_WriteBC1(uint8_t hdr[TTDDS_HDRSZ], uint16_t width, uint16_t height, uint32_t mipCount);
+
+// Parses the headers of a single 2D BC1 DDS, either a DXT1 one or a DX10 one of BC1_UNORM(_SRGB), and checks every
+// mipmap it says it has is in the size bytes at data. Dimensions over 65535 are TTDDS_E_INVLDSIZE since no TXTR can
+// hold them.
+TTDDSError_t TTDDS_ParseBC1(TTDDS_t *dds, size_t size, const uint8_t *data);
+
+// CMP is BC1 with the blocks of every 8x8 tile grouped together and big endian endpoints and pixels in each index byte
+// going from the high bits to the low ones. These move blocks between the two layouts and swap their byte and bit
+// order without looking at any pixel, so converting one way and back gives the same bytes. src and dst are
+// TTGX_Size(TXTR_TTF_CMP, ...) and TTDDS_BC1Size bytes. Blocks of a CMP tile that lie wholly outside the image (widths
+// or heights that aren't multiples of 8) are zero in TTDDS_BC1ToCMP's output.
+void TTDDS_CMPToBC1(const uint8_t *src, uint16_t width, uint16_t height, uint8_t *dst);
+void TTDDS_BC1ToCMP(const uint8_t *src, uint16_t width, uint16_t height, uint8_t *dst);
+#endif
@@ -0,0 +1,49 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTFS_H__
+#define __TTFS_H__
+#include <stddef.h>
+#include <stdbool.h>
+
+// Recursively lists every regular file under root whose extension matches ext (case insensitive, including the dot).
+// Symlinked directories are skipped. Paths are returned relative to root with '/' separators, sorted so runs are
+// reproducible. Free the result with TTFS_FreeList. Returns 0 on success or an errno value on failure.
+int TTFS_ListFiles(char *root, char *ext, char ***outPaths, size_t *outCount);
+
+void TTFS_FreeList(char **paths, size_t count);
+
+// Creates path and every missing parent directory of it. Returns 0 on success or an errno value on failure.
+int TTFS_MkDirs(char *path);
+
+// Returns a new string of path with its extension (if any) replaced by ext. The extension is only looked for in the
+// last path component.
+char *TTFS_ReplaceExt(char *path, char *ext);
+
+// Returns a new string of dir and name joined by a '/' unless dir already ends in a separator.
+char *TTFS_Join(char *dir, char *name);
+
+// Returns true if path ends with ext (case insensitive).
+bool TTFS_HasExt(char *path, char *ext);
+#endif
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTGX_H__
+#define __TTGX_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <txtr.h>
+
+// Whether fmt has decode kernels here (every format that isn't indexed).
+bool TTGX_CanDecode(TXTRFormat_t fmt);
+
+// Size of an image of fmt, which is always made of whole tiles. Tiles are 8x8 (I4, CMP), 8x4 (I8, IA4) or 4x4 (the
+// rest) pixels and 32 bytes except for RGBA8's 64 which are its AR pairs followed by its GB pairs. A CMP tile is four
+// 8 byte DXT1 blocks (top left, top right, bottom left, bottom right).
+size_t TTGX_Size(TXTRFormat_t fmt, uint16_t width, uint16_t height);
+
+// Decodes an image of a fmt TTGX_CanDecode takes into width * height RGBA8 pixels (rows top to bottom, like
+// TXTR_Decode without flips). The tiles are undone in the same pass that converts the pixels so there is no
+// intermediate buffer. src must be TTGX_Size bytes. Runs with the kernels of the instruction set TTISA_Active picked.
+void TTGX_Decode(TXTRFormat_t fmt, const uint8_t *src, uint16_t width, uint16_t height, uint8_t *dst);
+
+// Like TTGX_Decode but only decodes the w x h rectangle at x, y (which must lie inside the image) into w * h pixels.
+// Only the tiles the rectangle touches are read so the work and memory follow the rectangle rather than the image.
+void TTGX_DecodeRect(TXTRFormat_t fmt, const uint8_t *src, uint16_t width, uint16_t x, uint16_t y, uint16_t w,
+uint16_t h, uint8_t *dst);
+
+// Decodes images of fmt covering every value a pixel can have (every byte in every place of a tile for RGBA8 and, for
+// CMP, every pair of endpoint channel values in both of DXT1's modes with every index) with both the baseline kernels
+// and the active ones and sets outSame to whether the results are identical. Returns 0 on success or an errno value on
+// failure.
+int TTGX_Check(TXTRFormat_t fmt, bool *outSame);
+
+#define TTGX_TILES_PROTO(name) void name(const uint8_t *src, size_t count, uint8_t *dst, size_t dstStride)
+
+// Decodes count tiles lying next to each other in a tile row into the pixels at dst, whose rows are dstStride bytes
+// apart.
+typedef TTGX_TILES_PROTO((*TTGXTiles_t));
+
+// The decode kernels of every instruction set indexed by format (NULL for indexed ones). The baseline is plain C and
+// the others are in src/ttgx_isa.c.
+extern const TTGXTiles_t TTGX_DecodeTiles_baseline[TXTR_TTF_CMP + 1];
+extern const TTGXTiles_t TTGX_DecodeTiles_sse2[TXTR_TTF_CMP + 1];
+extern const TTGXTiles_t TTGX_DecodeTiles_avx[TXTR_TTF_CMP + 1];
+extern const TTGXTiles_t TTGX_DecodeTiles_avx2[TXTR_TTF_CMP + 1];
+#endif
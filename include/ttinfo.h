@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTINFO_H__
+#define __TTINFO_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <txtr.h>
+
+// Size of the fixed TXTR header and of the palette header following it in indexed textures
+#define TTINFO_HDRSZ 12
+#define TTINFO_PALHDRSZ 8
+
+typedef enum TTInfoError {
+    TTI_E_SUCCESS,
+    TTI_E_IO,
+    TTI_E_TRUNCATED,
+    TTI_E_INVLDTEXFMT,
+    TTI_E_INVLDPALFMT
+} TTInfoError_t;
+
+// The headers of a TXTR and the size of the file they came from.
+typedef struct TTInfo {
+    TXTRHeader_t hdr;
+    bool isIndexed;
+    TXTRPaletteHeader_t palHdr;
+    size_t fileSz;
+} TTInfo_t;
+
+char *TTInfoError_ToStr(TTInfoError_t e);
+
+// Parses the headers of a TXTR from the first bytes of it. size may be anything from the header's size up. Only the
+// formats are checked, everything else is left to TXTR_Read.
+TTInfoError_t TTInfo_Parse(TTInfo_t *info, size_t size, uint8_t *data);
+
+// Reads only the headers of the TXTR at path (at most TTINFO_HDRSZ + TTINFO_PALHDRSZ bytes, unbuffered) so getting
+// the format and dimensions of a texture costs the same no matter how large it is. errno is set on TTI_E_IO.
+TTInfoError_t TTInfo_Read(TTInfo_t *info, char *path);
+#endif
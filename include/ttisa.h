@@ -0,0 +1,55 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTISA_H__
+#define __TTISA_H__
+#include <stdbool.h>
+
+// Instruction sets the tool's kernels are built for. BASELINE is whatever the whole program is compiled for.
+typedef enum TTISA {
+    TTISA_INVALID = -1,
+    TTISA_BASELINE = 0,
+    TTISA_SSE2,
+    TTISA_AVX,
+    TTISA_AVX2,
+    TTISA_MIN = TTISA_BASELINE,
+    TTISA_MAX = TTISA_AVX2
+} TTISA_t;
+
+char *TTISA_ToStr(TTISA_t isa);
+
+TTISA_t TTISA_FromStr(char *str);
+
+// Whether kernels for isa were built in and the CPU (and OS) can run them.
+bool TTISA_Supported(TTISA_t isa);
+
+// The best supported instruction set.
+TTISA_t TTISA_Detect(void);
+
+// Makes every kernel use isa from now on. Returns false (changing nothing) if it isn't supported.
+bool TTISA_Select(TTISA_t isa);
+
+// The instruction set kernels currently use. Until TTISA_Select is called this is TTISA_BASELINE.
+TTISA_t TTISA_Active(void);
+#endif
@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __TTJSON_H__
+#define __TTJSON_H__
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum TTJSONType {
+    TTJSON_STRING,
+    TTJSON_NUMBER,
+    TTJSON_BOOL,
+    TTJSON_NULL,
+    TTJSON_ARRAY
+} TTJSONType_t;
+
+// A member of a parsed object. value is the unescaped text of strings, the literal text of numbers, true, false and
+// null, and the whole bracketed text of arrays (see TTJSON_ParseNumbers).
+typedef struct TTJSONField {
+    char *key;
+    TTJSONType_t type;
+    char *value;
+} TTJSONField_t;
+
+// Parses a single flat object (members may be scalars or arrays of scalars but not objects) in place, so keys and
+// values point into text which must outlive them. Returns 0 on success, E2BIG if there are more than maxFields members
+// or EINVAL if text is not such an object.
+int TTJSON_ParseObject(char *text, TTJSONField_t *fields, size_t maxFields, size_t *outCount);
+
+// Parses an array value holding only numbers. Returns 0 on success, E2BIG if it holds more than max numbers or EINVAL
+// if it holds anything else.
+int TTJSON_ParseNumbers(char *array, double *out, size_t max, size_t *outCount);
+
+// A growable text buffer to build JSON in, meant to be kept and reused by setting len back to 0. Once an allocation
+// fails failed is set and further appends do nothing.
+typedef struct TTJSONBuf {
+    char *data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} TTJSONBuf_t;
+
+void TTJSONBuf_Printf(TTJSONBuf_t *buf, const char *fmt, ...);
+
+// Appends str as a quoted and escaped JSON string.
+void TTJSONBuf_String(TTJSONBuf_t *buf, const char *str);
+
+void TTJSONBuf_Free(TTJSONBuf_t *buf);
+#endif
@@ -0,0 +1,46 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTMAP_H__
+#define __TTMAP_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// A private view of a whole file. The file is memory mapped where possible so reading it costs no heap buffer and
+// no copy out of the page cache, otherwise (pipes, special files, or mapping failing) it is read into the heap.
+// Either way writes to the data never reach the file. This only saves memory for as long as the view is what gets
+// read: a parser that copies the data out (like TXTR_Read and TGA_Read) needs the same memory it did with a heap read.
+typedef struct TTMap {
+    uint8_t *data;
+    size_t size;
+    bool mapped;
+} TTMap_t;
+
+// Opens a view of path. An empty file gives a view with a size of 0 and no data. Returns 0 on success or an errno
+// value on failure.
+int TTMap_Open(char *path, TTMap_t *map);
+
+void TTMap_Close(TTMap_t *map);
+#endif
@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTPOOL_H__
+#define __TTPOOL_H__
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// A job callback. job is the index of the job to run and worker is the index of the worker running it (0 is always the
+// calling thread) so per-worker state can be kept in an array sized to the thread count.
+typedef void (*TTPoolJob_t)(void *ctx, size_t job, size_t worker);
+
+// Number of logical processors available to the process (never less than 1).
+size_t TTPool_CPUCount(void);
+
+// Resolves a requested thread count where 0 means one thread per logical processor. The result is never more than
+// jobCount (no point in idle workers) and never less than 1.
+size_t TTPool_ThreadCount(size_t requested, size_t jobCount);
+
+// Runs jobs 0 to jobCount - 1 across threadCount workers (see TTPool_ThreadCount) and waits for all of them. Every
+// worker starts with an equal contiguous share of the jobs and steals from the others once its own share runs out, so
+// uneven job sizes still keep every worker busy. The calling thread is always worker 0 so if no extra threads could be
+// started the jobs still run, just serially. No new jobs are started once catexit_loopSafety goes false.
+void TTPool_Run(size_t threadCount, size_t jobCount, TTPoolJob_t job, void *ctx);
+
+// A shared byte budget jobs reserve from before allocating so the sum of in flight allocations stays under limit.
+typedef struct TTBudget {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t limit;
+    size_t inUse;
+} TTBudget_t;
+
+// A limit of 0 means unlimited. Returns false if the synchronization primitives could not be created.
+bool TTBudget_Init(TTBudget_t *budget, size_t limit);
+
+// Blocks until amount fits within the budget and reserves it. Amounts larger than the whole budget are clamped to it
+// so such a job runs alone instead of never. Returns the amount actually reserved to hand to TTBudget_Release.
+size_t TTBudget_Acquire(TTBudget_t *budget, size_t amount);
+
+void TTBudget_Release(TTBudget_t *budget, size_t amount);
+
+void TTBudget_Free(TTBudget_t *budget);
+#endif
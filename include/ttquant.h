@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTQUANT_H__
+#define __TTQUANT_H__
+#include <stddef.h>
+#include <stdint.h>
+
+#include <txtr.h>
+
+// A node of TTQuant_t's k-d tree. Leaves hold up to TTQUANT_LEAFSZ colours starting at first, other nodes split their
+// colours on axis at value with the lower ones going to the node right after them and the rest to node right.
+typedef struct TTQuantNode {
+    uint32_t right;
+    uint16_t first;
+    uint16_t count;
+    uint8_t axis;
+    uint8_t value;
+    uint8_t isLeaf;
+} TTQuantNode_t;
+
+#define TTQUANT_LEAFSZ 8
+
+// A palette and a k-d tree over it for nearest colour lookups.
+typedef struct TTQuant {
+    uint8_t (*colors)[4];
+    size_t count;
+    // The palette in tree order and which entry each of those is
+    uint8_t (*treeColors)[4];
+    uint16_t *treeIndices;
+    TTQuantNode_t *nodes;
+    size_t nodeCount;
+} TTQuant_t;
+
+// The most colours a palette of fmt can hold (0 if it isn't indexed).
+size_t TTQuant_PaletteSize(TXTRFormat_t fmt);
+
+// Builds a palette of at most maxColors (up to 65536) RGBA8 colours for pixels by median cut, weighted by how often
+// each colour occurs. Images with no more colours than that get exactly their colours. The colours are rounded to what
+// palFmt can store so nothing changes once the palette is encoded. Returns 0 on success or an errno value on failure.
+int TTQuant_Build(TTQuant_t *q, const uint8_t *pixels, size_t pixelCount, size_t maxColors,
+TXTRPaletteFormat_t palFmt);
+
+// The index of the palette colour closest to px (squared distance over R, G, B and A).
+uint16_t TTQuant_Nearest(TTQuant_t *q, const uint8_t px[4]);
+
+// Replaces every pixel with its closest palette colour, diffusing the difference to the pixels not done yet with the
+// kernel of ditherType (GX_DT_THRESHOLD diffuses nothing). Rows are spread over threads workers (see
+// TTPool_ThreadCount) and the result is the same as with one. Returns 0 on success or an errno value on failure.
+int TTQuant_Dither(TTQuant_t *q, GXDitherType_t ditherType, uint8_t *pixels, uint16_t width, uint16_t height,
+size_t threads);
+
+void TTQuant_Free(TTQuant_t *q);
+#endif
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+    
+#ifndef __TTRESIZE_H__
+#define __TTRESIZE_H__
+#include <stddef.h>
+#include <stdint.h>
+    
+#include <stb_image_resize2.h>
+    
+#define TTRESIZE_PROTO(name) void *name(const void *input, int inputW, int inputH, int inputStride, void *output, \
+    int outputW, int outputH, int outputStride, stbir_pixel_layout layout, stbir_datatype type, stbir_edge edge, \
+    stbir_filter filter)
+
+// stbir_resize built for the instruction set TTISA_Active picked.
+TTRESIZE_PROTO(TTResize);
+
+// The per instruction set builds of it (src/ttresize_isa.c).
+TTRESIZE_PROTO(TTResize_sse2);
+TTRESIZE_PROTO(TTResize_avx);
+TTRESIZE_PROTO(TTResize_avx2);
+
+// The steps stbir_resize takes split so a resize can be set up once and run many times. build makes the samplers
+// (filter kernels, contributor tables and scratch memory) of a shape, run resizes one image with them and release
+// frees them. Samplers can only be run and released by the build of stb_image_resize2 that made them.
+typedef struct TTResizeOps {
+    int (*build)(STBIR_RESIZE *resize, int inputW, int inputH, int inputStride, int outputW, int outputH,
+        int outputStride, stbir_pixel_layout layout, stbir_datatype type, stbir_edge edge, stbir_filter filter);
+    int (*run)(STBIR_RESIZE *resize, const void *input, int inputStride, void *output, int outputStride);
+    void (*release)(STBIR_RESIZE *resize);
+} TTResizeOps_t;
+
+// Defines the TTResizeOps_t name with whichever stb_image_resize2 is in scope, once per file
+#define TTRESIZE_DEFINE_OPS(name) \
+    static int TTResize_build(STBIR_RESIZE *resize, int inputW, int inputH, int inputStride, int outputW, \
+    int outputH, int outputStride, stbir_pixel_layout layout, stbir_datatype type, stbir_edge edge, \
+    stbir_filter filter) { \
+        stbir_resize_init(resize, NULL, inputW, inputH, inputStride, NULL, outputW, outputH, outputStride, layout, \
+            type); \
+        return stbir_set_edgemodes(resize, edge, edge) && stbir_set_filters(resize, filter, filter) && \
+            stbir_build_samplers(resize); \
+    } \
+    static int TTResize_run(STBIR_RESIZE *resize, const void *input, int inputStride, void *output, \
+    int outputStride) { \
+        stbir_set_buffer_ptrs(resize, input, inputStride, output, outputStride); \
+        return stbir_resize_extended(resize); \
+    } \
+    static void TTResize_release(STBIR_RESIZE *resize) { \
+        stbir_free_samplers(resize); \
+    } \
+    const TTResizeOps_t name = { .build = TTResize_build, .run = TTResize_run, .release = TTResize_release }
+
+extern const TTResizeOps_t TTResizeOps_baseline;
+extern const TTResizeOps_t TTResizeOps_sse2;
+extern const TTResizeOps_t TTResizeOps_avx;
+extern const TTResizeOps_t TTResizeOps_avx2;
+
+// Shapes a cache keeps samplers for, enough for every level of a mipmap chain with room to spare
+#define TTRESIZE_CACHESZ 16
+
+// A shape and the samplers built for it
+typedef struct TTResizeEntry {
+    const TTResizeOps_t *ops;
+    STBIR_RESIZE resize;
+    int inputW;
+    int inputH;
+    int inputStride;
+    int outputW;
+    int outputH;
+    int outputStride;
+    stbir_pixel_layout layout;
+    stbir_datatype type;
+    stbir_edge edge;
+    stbir_filter filter;
+    uint64_t lastUse;
+} TTResizeEntry_t;
+
+// Built samplers of the last shapes resized, so resizing the levels of file after file of the same size only sets up
+// each level's samplers once. Full caches drop the shape used longest ago. Not thread safe, a cache belongs to one
+// worker.
+typedef struct TTResizeCache {
+    TTResizeEntry_t entries[TTRESIZE_CACHESZ];
+    size_t count;
+    // Resizes done so far, which also orders the entries by their last use
+    uint64_t clock;
+    // Resizes that found their shape's samplers already built
+    uint64_t hits;
+} TTResizeCache_t;
+
+void TTResizeCache_Init(TTResizeCache_t *cache);
+
+// TTResize through the cache's samplers for the shape, building them first if the cache has none (or has ones for
+// another instruction set than TTISA_Active). A NULL cache just calls TTResize.
+void *TTResizeCache_Resize(TTResizeCache_t *cache, const void *input, int inputW, int inputH, int inputStride,
+void *output, int outputW, int outputH, int outputStride, stbir_pixel_layout layout, stbir_datatype type,
+stbir_edge edge, stbir_filter filter);
+
+// Frees every entry's samplers. The cache stays usable and starts over empty, apart from its counters.
+void TTResizeCache_Free(TTResizeCache_t *cache);
+#endif
@@ -0,0 +1,45 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __TTSERVE_H__
+#define __TTSERVE_H__
+#include <stddef.h>
+
+#include <ttjson.h>
+
+// Runs one request line on a worker and fills reply (cleared beforehand and kept per worker so its buffer is reused)
+// with the response line, without the newline. Nothing is sent back if reply is left empty.
+typedef void (*TTServeHandler_t)(void *ctx, char *line, TTJSONBuf_t *reply, size_t worker);
+
+// Serves newline separated requests with threads workers (see TTPool_ThreadCount) that stay up until the server stops.
+// With a NULL socketPath requests are read from stdin and responses written to stdout until stdin ends. Otherwise a
+// UNIX socket only its owner may connect to (mode 0600) is listened on at socketPath (replacing a stale socket there)
+// and every connection gets the responses to its own requests until catexit_loopSafety goes false. Responses of one
+// connection may come back in a different order than its requests when there is more than one worker. Empty lines are
+// skipped and a connection sending a line over 1 MiB is dropped. Requests queued when the server stops are still run
+// unless it was interrupted. SIGPIPE is ignored while serving, so a reader going away only ends its own responses.
+// Returns 0 on success or an errno value on failure.
+int TTServe_Run(char *socketPath, size_t threads, TTServeHandler_t handler, void *ctx);
+#endif
@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TTTGA_H__
+#define __TTTGA_H__
+#include <stddef.h>
+#include <stdint.h>
+
+#include <tga.h>
+
+typedef enum TTTGAError {
+    TTTGA_E_SUCCESS,
+    TTTGA_E_TRUNCATED,
+    TTTGA_E_NOTCOLORMAPPED,
+    TTTGA_E_INVLDMAP,
+    TTTGA_E_INVLDPXLDEP,
+    TTTGA_E_INVLDSIZE,
+    TTTGA_E_RIGHTTOLEFT,
+    TTTGA_E_INVLDINDEX,
+    TTTGA_E_MEMFAIL
+} TTTGAError_t;
+
+char *TTTGAError_ToStr(TTTGAError_t e);
+
+// The colour map and indices of a colour mapped TGA. map holds mapLength entries in the bytes the pixels they expand
+// to get and indices one per pixel, rows in the file's order, counted from the map's first entry.
+typedef struct TTTGAIndexed {
+    uint16_t mapLength;
+    uint8_t (*map)[4];
+    uint16_t *indices;
+} TTTGAIndexed_t;
+
+// Reads a colour mapped TGA (TGA_Read turns these away), uncompressed or RLE with 8 or 16 bit indices into a 15, 16,
+// 24 or 32 bit colour map, into tga as TGA_Read would read the 32 bit true colour TGA of the same image: every pixel
+// is its map entry's B, G, R and A bytes and rows stay in the file's order. Images whose pixels run right to left are
+// turned away rather than read mirrored. The colour map fields of the header are kept so callers can tell the image
+// has no more colours than hdr.colorMapSpec.colorMapLength. If indexed is not NULL it also gets the map and indices the
+// pixels came from. Free with TGA_free and TTTGA_FreeIndexed.
+TTTGAError_t TTTGA_ReadColorMapped(TGA_t *tga, TTTGAIndexed_t *indexed, size_t size, const uint8_t *data);
+
+// Frees what TTTGA_ReadColorMapped put in indexed. Does nothing for a zeroed one.
+void TTTGA_FreeIndexed(TTTGAIndexed_t *indexed);
+#endif
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttarena.h>
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <stdext.h>
+
+#define TTARENA_ALIGN 16
+
+struct TTArenaBlock {
+    TTArenaBlock_t *next;
+    size_t size;
+    size_t used;
+};
+
+// Block headers are padded so the data after them starts aligned
+#define TTARENA_HDRSZ ((sizeof(TTArenaBlock_t) + TTARENA_ALIGN - 1) & ~(size_t) (TTARENA_ALIGN - 1))
+
+FORCE_INLINE uint8_t *TTArena_data(TTArenaBlock_t *block) {
+    return (uint8_t *) block + TTARENA_HDRSZ;
+}
+
+static TTArenaBlock_t *TTArena_newBlock(TTArena_t *arena, size_t size) {
+    if (size > SIZE_MAX - TTARENA_HDRSZ)
+        return NULL;
+    
+    TTArenaBlock_t *block = malloc(TTARENA_HDRSZ + size);
+    if (!block)
+        return NULL;
+    
+    block->next = arena->blocks;
+    block->size = size;
+    block->used = 0;
+    arena->blocks = block;
+    arena->heapAllocs++;
+    return block;
+}
+
+FORCE_INLINE void TTArena_freeBlocks(TTArena_t *arena) {
+    while (arena->blocks) {
+        TTArenaBlock_t *next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+}
+
+void TTArena_Init(TTArena_t *arena, size_t blockSize) {
+    *arena = (TTArena_t) {
+        .blocks = NULL,
+        .blockSize = blockSize ? blockSize : TTARENA_BLOCKSZ,
+        .used = 0,
+        .peak = 0,
+        .allocs = 0,
+        .heapAllocs = 0
+    };
+}
+
+void *TTArena_Alloc(TTArena_t *arena, size_t size) {
+    if (size > SIZE_MAX - TTARENA_ALIGN)
+        return NULL;
+    size = size ? (size + TTARENA_ALIGN - 1) & ~(size_t) (TTARENA_ALIGN - 1) : TTARENA_ALIGN;
+    
+    // Only the newest block is bumped, whatever is left at the end of older ones waits for the reset
+    TTArenaBlock_t *block = arena->blocks;
+    if (!block || block->size - block->used < size) {
+        block = TTArena_newBlock(arena, size > arena->blockSize ? size : arena->blockSize);
+        if (!block)
+            return NULL;
+    }
+    
+    void *p = TTArena_data(block) + block->used;
+    block->used += size;
+    arena->used += size;
+    if (arena->peak < arena->used)
+        arena->peak = arena->used;
+    arena->allocs++;
+    return p;
+}
+
+void TTArena_Reset(TTArena_t *arena) {
+    size_t total = 0;
+    for (TTArenaBlock_t *block = arena->blocks; block; block = block->next) {
+        block->used = 0;
+        total += block->size;
+    }
+    arena->used = 0;
+    
+    if (arena->blocks && arena->blocks->next) {
+        // If the merged block can't be had the arena just starts over from nothing
+        TTArena_freeBlocks(arena);
+        TTArena_newBlock(arena, total);
+    }
+}
+
+void TTArena_Free(TTArena_t *arena) {
+    TTArena_freeBlocks(arena);
+    arena->used = 0;
+}
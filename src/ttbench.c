@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttbench.h>
+
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef TXTRTOOL_BENCH_ALLOCS
+static uint64_t ttBenchAllocs = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    __atomic_fetch_add(&ttBenchAllocs, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    __atomic_fetch_add(&ttBenchAllocs, 1, __ATOMIC_RELAXED);
+    return __real_calloc(count, size);
+}
+
+// Only counted when it has to allocate a new block
+void *__wrap_realloc(void *ptr, size_t size) {
+    if (!ptr)
+        __atomic_fetch_add(&ttBenchAllocs, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+#endif
+
+uint64_t TTBench_Now(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq = { .QuadPart = 0 };
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (uint64_t) (now.QuadPart / freq.QuadPart) * 1000000000ULL +
+        (uint64_t) (now.QuadPart % freq.QuadPart) * 1000000000ULL / (uint64_t) freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static int TTBench_cmpSamples(const void *a, const void *b) {
+    uint64_t sa = *(const uint64_t *) a, sb = *(const uint64_t *) b;
+    return sa < sb ? -1 : sa > sb;
+}
+
+void TTBench_Summarize(uint64_t *samples, size_t count, TTBenchStats_t *stats) {
+    *stats = (TTBenchStats_t) { .total = 0, .mean = 0, .min = 0, .p50 = 0, .p99 = 0, .max = 0 };
+    if (!count)
+        return;
+    
+    qsort(samples, count, sizeof(uint64_t), TTBench_cmpSamples);
+    for (size_t i = 0; i < count; i++)
+        stats->total += samples[i];
+    stats->mean = stats->total / count;
+    stats->min = samples[0];
+    // Nearest rank
+    stats->p50 = samples[(count * 50 + 99) / 100 - 1];
+    stats->p99 = samples[(count * 99 + 99) / 100 - 1];
+    stats->max = samples[count - 1];
+}
+
+bool TTBench_CountsAllocs(void) {
+#ifdef TXTRTOOL_BENCH_ALLOCS
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t TTBench_Allocs(void) {
+#ifdef TXTRTOOL_BENCH_ALLOCS
+    return __atomic_load_n(&ttBenchAllocs, __ATOMIC_RELAXED);
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,341 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttcache.h>
+#include <ttfs.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+#include <stdext.h>
+
+#define TTCACHE_EXT ".txtr"
+#define TTCACHE_TMPEXT ".tmp"
+
+#define TTCACHE_PRIME1 0x9E3779B185EBCA87ULL
+#define TTCACHE_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define TTCACHE_PRIME3 0x165667B19E3779F9ULL
+#define TTCACHE_PRIME4 0x85EBCA77C2B2AE63ULL
+#define TTCACHE_PRIME5 0x27D4EB2F165667C5ULL
+
+typedef struct TTCacheEntry {
+    char *path;
+    uint64_t size;
+    time_t mtime;
+} TTCacheEntry_t;
+
+FORCE_INLINE uint64_t TTCache_rotl(uint64_t v, int r) {
+    return (v << r) | (v >> (64 - r));
+}
+
+FORCE_INLINE uint64_t TTCache_read64(const uint8_t *p) {
+    return (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24) |
+        ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) | ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+}
+
+FORCE_INLINE uint64_t TTCache_read32(const uint8_t *p) {
+    return (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24);
+}
+
+FORCE_INLINE uint64_t TTCache_round(uint64_t acc, uint64_t input) {
+    return TTCache_rotl(acc + input * TTCACHE_PRIME2, 31) * TTCACHE_PRIME1;
+}
+
+FORCE_INLINE uint64_t TTCache_merge(uint64_t acc, uint64_t v) {
+    return (acc ^ TTCache_round(0, v)) * TTCACHE_PRIME1 + TTCACHE_PRIME4;
+}
+
+uint64_t TTCache_Hash(const void *data, size_t size, uint64_t seed) {
+    const uint8_t *p = data;
+    const uint8_t *end = p + size;
+    uint64_t h;
+    
+    if (size >= 32) {
+        uint64_t v1 = seed + TTCACHE_PRIME1 + TTCACHE_PRIME2;
+        uint64_t v2 = seed + TTCACHE_PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - TTCACHE_PRIME1;
+        for (; end - p >= 32; p += 32) {
+            v1 = TTCache_round(v1, TTCache_read64(p));
+            v2 = TTCache_round(v2, TTCache_read64(p + 8));
+            v3 = TTCache_round(v3, TTCache_read64(p + 16));
+            v4 = TTCache_round(v4, TTCache_read64(p + 24));
+        }
+        h = TTCache_rotl(v1, 1) + TTCache_rotl(v2, 7) + TTCache_rotl(v3, 12) + TTCache_rotl(v4, 18);
+        h = TTCache_merge(h, v1);
+        h = TTCache_merge(h, v2);
+        h = TTCache_merge(h, v3);
+        h = TTCache_merge(h, v4);
+    } else
+        h = seed + TTCACHE_PRIME5;
+    h += size;
+    
+    for (; end - p >= 8; p += 8)
+        h = TTCache_rotl(h ^ TTCache_round(0, TTCache_read64(p)), 27) * TTCACHE_PRIME1 + TTCACHE_PRIME4;
+    if (end - p >= 4) {
+        h = TTCache_rotl(h ^ (TTCache_read32(p) * TTCACHE_PRIME1), 23) * TTCACHE_PRIME2 + TTCACHE_PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++)
+        h = TTCache_rotl(h ^ (*p * TTCACHE_PRIME5), 11) * TTCACHE_PRIME1;
+    
+    h ^= h >> 33;
+    h *= TTCACHE_PRIME2;
+    h ^= h >> 29;
+    h *= TTCACHE_PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Entries are spread over 256 subdirectories by the first byte of their key so no directory gets huge
+static char *TTCache_entryPath(TTCache_t *cache, TTCacheKey_t key, char *ext) {
+    return csprintf_s("%s/%02x/%016llx%016llx%s", cache->dir, (unsigned) (key.content >> 56),
+        (unsigned long long) key.content, (unsigned long long) key.options, ext);
+}
+
+static int TTCache_copy(char *input, char *output) {
+#ifdef __linux__
+    // A reflink shares the blocks of the entry instead of copying them on file systems that support it
+    int inFd = open(input, O_RDONLY);
+    if (inFd != -1) {
+        int outFd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (outFd != -1) {
+            bool cloned = !ioctl(outFd, FICLONE, inFd);
+            bool closed = !close(outFd);
+            close(inFd);
+            if (cloned && closed)
+                return 0;
+        } else
+            close(inFd);
+    }
+#endif
+    
+    FILE *in, *out;
+    if (cfopen(input, "rb", &in))
+        return errno;
+    if (cfopen(output, "wb", &out)) {
+        int err = errno;
+        cfclose(in);
+        return err;
+    }
+    
+    int err = 0;
+    uint8_t buf[65536];
+    size_t got;
+    while (!err && (got = fread(buf, sizeof(uint8_t), sizeof(buf), in)))
+        if (fwrite(buf, sizeof(uint8_t), got, out) != got)
+            err = errno ? errno : EIO;
+    if (!err && ferror(in))
+        err = errno ? errno : EIO;
+    cfclose(in);
+    if (cfclose(out) && !err)
+        err = errno;
+    return err;
+}
+
+static int TTCache_cmpEntries(const void *a, const void *b) {
+    const TTCacheEntry_t *ea = a, *eb = b;
+    return ea->mtime < eb->mtime ? -1 : ea->mtime > eb->mtime;
+}
+
+// Lists every entry with its size and last use. Sums up the total size if size isn't NULL.
+static int TTCache_scan(TTCache_t *cache, TTCacheEntry_t **outEntries, size_t *outCount, uint64_t *size) {
+    char **paths = NULL;
+    size_t pathCount = 0;
+    int err = TTFS_ListFiles(cache->dir, TTCACHE_EXT, &paths, &pathCount);
+    if (err)
+        return err;
+    
+    TTCacheEntry_t *entries = pathCount ? malloc(sizeof(TTCacheEntry_t) * pathCount) : NULL;
+    if (pathCount && !entries) {
+        TTFS_FreeList(paths, pathCount);
+        return ENOMEM;
+    }
+    
+    size_t count = 0;
+    uint64_t total = 0;
+    for (size_t i = 0; i < pathCount; i++) {
+        char *path = TTFS_Join(cache->dir, paths[i]);
+        struct stat st;
+        if (!path || stat(path, &st)) {
+            free(path);
+            continue;
+        }
+        entries[count++] = (TTCacheEntry_t) { .path = path, .size = (uint64_t) st.st_size, .mtime = st.st_mtime };
+        total += (uint64_t) st.st_size;
+    }
+    TTFS_FreeList(paths, pathCount);
+    
+    *outEntries = entries;
+    *outCount = count;
+    if (size)
+        *size = total;
+    return 0;
+}
+
+// Brings the cache down to 3/4 of its limit so eviction doesn't have to rescan on every store. Called with the lock
+// held.
+static void TTCache_evict(TTCache_t *cache) {
+    TTCacheEntry_t *entries;
+    size_t count;
+    uint64_t size;
+    if (TTCache_scan(cache, &entries, &count, &size))
+        return;
+    
+    if (count)
+        qsort(entries, count, sizeof(TTCacheEntry_t), TTCache_cmpEntries);
+    uint64_t target = cache->limit / 4 * 3;
+    for (size_t i = 0; i < count; i++) {
+        if (size > target && !remove(entries[i].path)) {
+            size -= entries[i].size;
+            cache->evictions++;
+        }
+        free(entries[i].path);
+    }
+    free(entries);
+    cache->size = size;
+}
+
+int TTCache_Open(TTCache_t *cache, char *dir, uint64_t limit) {
+    int err = TTFS_MkDirs(dir);
+    if (err)
+        return err;
+    
+    cache->dir = csprintf_s("%s", dir);
+    if (!cache->dir)
+        return ENOMEM;
+    cache->limit = limit;
+    cache->size = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->stores = 0;
+    cache->evictions = 0;
+    cache->tmpCounter = 0;
+    
+    TTCacheEntry_t *entries;
+    size_t count;
+    if ((err = TTCache_scan(cache, &entries, &count, &cache->size))) {
+        free(cache->dir);
+        return err;
+    }
+    for (size_t i = 0; i < count; i++)
+        free(entries[i].path);
+    free(entries);
+    
+    if (pthread_mutex_init(&cache->lock, NULL)) {
+        free(cache->dir);
+        return ENOMEM;
+    }
+    return 0;
+}
+
+void TTCache_Close(TTCache_t *cache) {
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->dir);
+    cache->dir = NULL;
+}
+
+bool TTCache_Fetch(TTCache_t *cache, TTCacheKey_t key, char *output) {
+    char *path = TTCache_entryPath(cache, key, TTCACHE_EXT);
+    bool hit = path && !TTCache_copy(path, output);
+    // Touching the entry is what makes it recently used
+    if (hit)
+        utime(path, NULL);
+    free(path);
+    
+    pthread_mutex_lock(&cache->lock);
+    if (hit)
+        cache->hits++;
+    else
+        cache->misses++;
+    pthread_mutex_unlock(&cache->lock);
+    return hit;
+}
+
+int TTCache_Store(TTCache_t *cache, TTCacheKey_t key, char *input) {
+    pthread_mutex_lock(&cache->lock);
+    size_t tmpId = cache->tmpCounter++;
+    pthread_mutex_unlock(&cache->lock);
+    
+    // Entries are copied in under a unique name and renamed into place so a reader never sees half an entry
+    char *path = TTCache_entryPath(cache, key, TTCACHE_EXT);
+    char *tmpExt = csprintf_s(".%zu" TTCACHE_TMPEXT, tmpId);
+    char *tmpPath = tmpExt ? TTCache_entryPath(cache, key, tmpExt) : NULL;
+    free(tmpExt);
+    char *subdir = path ? csprintf_s("%.*s", (int) (strlen(cache->dir) + 3), path) : NULL;
+    if (!path || !tmpPath || !subdir) {
+        free(path);
+        free(tmpPath);
+        free(subdir);
+        return ENOMEM;
+    }
+    
+    int err = TTFS_MkDirs(subdir);
+    if (!err)
+        err = TTCache_copy(input, tmpPath);
+    struct stat st;
+    if (!err && stat(tmpPath, &st))
+        err = errno;
+    if (!err) {
+        // Another worker may have just stored the same entry, which is fine since it has the same content
+#ifdef _WIN32
+        // rename doesn't replace existing files here
+        remove(path);
+#endif
+        if (rename(tmpPath, path))
+            err = errno;
+    }
+    if (err)
+        remove(tmpPath);
+    free(subdir);
+    free(tmpPath);
+    free(path);
+    if (err)
+        return err;
+    
+    pthread_mutex_lock(&cache->lock);
+    cache->stores++;
+    cache->size += (uint64_t) st.st_size;
+    if (cache->limit && cache->size > cache->limit)
+        TTCache_evict(cache);
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+}
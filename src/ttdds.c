@@ -0,0 +1,187 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttdds.h>
+
+#include <string.h>
+
+#include <stdext.h>
+
+#include <ttgx.h>
+
+// Header flags and pixel format bits and codes a BC1 DDS uses
+#define TTDDS_DDSD_CAPS 0x1u
+#define TTDDS_DDSD_HEIGHT 0x2u
+#define TTDDS_DDSD_WIDTH 0x4u
+#define TTDDS_DDSD_PIXELFORMAT 0x1000u
+#define TTDDS_DDSD_MIPMAPCOUNT 0x20000u
+#define TTDDS_DDSD_LINEARSIZE 0x80000u
+#define TTDDS_DDPF_FOURCC 0x4u
+#define TTDDS_DDSCAPS_COMPLEX 0x8u
+#define TTDDS_DDSCAPS_TEXTURE 0x1000u
+#define TTDDS_DDSCAPS_MIPMAP 0x400000u
+#define TTDDS_DDSCAPS2_CUBEMAP 0x200u
+#define TTDDS_DDSCAPS2_VOLUME 0x200000u
+#define TTDDS_DXGI_BC1_UNORM 71u
+#define TTDDS_DXGI_BC1_UNORM_SRGB 72u
+#define TTDDS_DIMENSION_TEXTURE2D 3u
+#define TTDDS_MISC_TEXTURECUBE 0x4u
+
+static char *_TTDDSError_ToStr[6] = {
+    [TTDDS_E_SUCCESS] = "Success",
+    [TTDDS_E_TRUNCATED] = "File is too small for its header or mipmaps",
+    [TTDDS_E_NOTDDS] = "Not a DDS file",
+    [TTDDS_E_NOTBC1] = "Not a BC1 (DXT1) texture",
+    [TTDDS_E_NOT2D] = "Not a single 2D texture (cube map, volume or array)",
+    [TTDDS_E_INVLDSIZE] = "Invalid width or height"
+};
+
+FORCE_INLINE uint32_t TTDDS_readLE32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+FORCE_INLINE void TTDDS_writeLE32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+    p[2] = (uint8_t) (v >> 16);
+    p[3] = (uint8_t) (v >> 24);
+}
+
+char *TTDDSError_ToStr(TTDDSError_t e) {
+    return e >= TTDDS_E_SUCCESS && e <= TTDDS_E_INVLDSIZE ? _TTDDSError_ToStr[e] : "Unknown error";
+}
+
+size_t TTDDS_BC1Size(uint16_t width, uint16_t height) {
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+void TTDDS_WriteBC1(uint8_t hdr[TTDDS_HDRSZ], uint16_t width, uint16_t height, uint32_t mipCount) {
+    memset(hdr, 0, TTDDS_HDRSZ);
+    memcpy(hdr, "DDS ", 4);
+    TTDDS_writeLE32(&hdr[4], 124);
+    TTDDS_writeLE32(&hdr[8], TTDDS_DDSD_CAPS | TTDDS_DDSD_HEIGHT | TTDDS_DDSD_WIDTH | TTDDS_DDSD_PIXELFORMAT |
+        TTDDS_DDSD_LINEARSIZE | (mipCount > 1 ? TTDDS_DDSD_MIPMAPCOUNT : 0));
+    TTDDS_writeLE32(&hdr[12], height);
+    TTDDS_writeLE32(&hdr[16], width);
+    TTDDS_writeLE32(&hdr[20], (uint32_t) TTDDS_BC1Size(width, height));
+    TTDDS_writeLE32(&hdr[28], mipCount);
+    // Pixel format
+    TTDDS_writeLE32(&hdr[76], 32);
+    TTDDS_writeLE32(&hdr[80], TTDDS_DDPF_FOURCC);
+    memcpy(&hdr[84], "DXT1", 4);
+    TTDDS_writeLE32(&hdr[108], TTDDS_DDSCAPS_TEXTURE | (mipCount > 1 ? TTDDS_DDSCAPS_COMPLEX | TTDDS_DDSCAPS_MIPMAP :
+        0));
+}
+
+TTDDSError_t TTDDS_ParseBC1(TTDDS_t *dds, size_t size, const uint8_t *data) {
+    if (size < 4 || memcmp(data, "DDS ", 4))
+        return size < 4 ? TTDDS_E_TRUNCATED : TTDDS_E_NOTDDS;
+    if (size < TTDDS_HDRSZ)
+        return TTDDS_E_TRUNCATED;
+    if (TTDDS_readLE32(&data[4]) != 124 || TTDDS_readLE32(&data[76]) != 32)
+        return TTDDS_E_NOTDDS;
+    
+    size_t offset = TTDDS_HDRSZ;
+    if (!(TTDDS_readLE32(&data[80]) & TTDDS_DDPF_FOURCC))
+        return TTDDS_E_NOTBC1;
+    if (!memcmp(&data[84], "DX10", 4)) {
+        if (size < TTDDS_HDRSZ + TTDDS_DX10HDRSZ)
+            return TTDDS_E_TRUNCATED;
+        const uint8_t *dx10 = &data[TTDDS_HDRSZ];
+        uint32_t format = TTDDS_readLE32(dx10);
+        if (format != TTDDS_DXGI_BC1_UNORM && format != TTDDS_DXGI_BC1_UNORM_SRGB)
+            return TTDDS_E_NOTBC1;
+        if (TTDDS_readLE32(&dx10[4]) != TTDDS_DIMENSION_TEXTURE2D ||
+            (TTDDS_readLE32(&dx10[8]) & TTDDS_MISC_TEXTURECUBE) || TTDDS_readLE32(&dx10[12]) > 1)
+            return TTDDS_E_NOT2D;
+        offset += TTDDS_DX10HDRSZ;
+    } else if (memcmp(&data[84], "DXT1", 4))
+        return TTDDS_E_NOTBC1;
+    if (TTDDS_readLE32(&data[112]) & (TTDDS_DDSCAPS2_CUBEMAP | TTDDS_DDSCAPS2_VOLUME))
+        return TTDDS_E_NOT2D;
+    
+    uint32_t height = TTDDS_readLE32(&data[12]);
+    uint32_t width = TTDDS_readLE32(&data[16]);
+    if (!width || !height || width > UINT16_MAX || height > UINT16_MAX)
+        return TTDDS_E_INVLDSIZE;
+    // Writers don't agree on whether the mipmap count flag is set, a count of 0 is taken as 1 like most readers do
+    uint32_t mipCount = TTDDS_readLE32(&data[28]);
+    if (!mipCount)
+        mipCount = 1;
+    
+    size_t need = offset;
+    uint16_t mipWidth = (uint16_t) width;
+    uint16_t mipHeight = (uint16_t) height;
+    for (uint32_t m = 0; m < mipCount; m++) {
+        need += TTDDS_BC1Size(mipWidth, mipHeight);
+        if (need > size)
+            return TTDDS_E_TRUNCATED;
+        mipWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+        mipHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+    }
+    
+    dds->width = (uint16_t) width;
+    dds->height = (uint16_t) height;
+    dds->mipCount = mipCount;
+    dds->dataOffset = offset;
+    return TTDDS_E_SUCCESS;
+}
+
+// Swaps the endpoints' bytes and mirrors the four 2 bit indices of each row byte, which is the same both ways
+FORCE_INLINE void TTDDS_swapBlock(const uint8_t *src, uint8_t *dst) {
+    dst[0] = src[1];
+    dst[1] = src[0];
+    dst[2] = src[3];
+    dst[3] = src[2];
+    for (size_t r = 4; r < 8; r++) {
+        uint8_t row = (uint8_t) ((src[r] >> 4) | (src[r] << 4));
+        dst[r] = (uint8_t) (((row >> 2) & 0x33) | ((row & 0x33) << 2));
+    }
+}
+
+// The offset of the 4x4 block at bx, by in a CMP image whose tile rows are tileRowSz bytes
+FORCE_INLINE size_t TTDDS_cmpBlock(size_t bx, size_t by, size_t tileRowSz) {
+    return by / 2 * tileRowSz + bx / 2 * 32 + ((by & 1) * 2 + (bx & 1)) * 8;
+}
+
+void TTDDS_CMPToBC1(const uint8_t *src, uint16_t width, uint16_t height, uint8_t *dst) {
+    size_t blocksX = (width + 3) / 4;
+    size_t blocksY = (height + 3) / 4;
+    size_t tileRowSz = (size_t) (width + 7) / 8 * 32;
+    for (size_t by = 0; by < blocksY; by++)
+        for (size_t bx = 0; bx < blocksX; bx++, dst += 8)
+            TTDDS_swapBlock(&src[TTDDS_cmpBlock(bx, by, tileRowSz)], dst);
+}
+
+void TTDDS_BC1ToCMP(const uint8_t *src, uint16_t width, uint16_t height, uint8_t *dst) {
+    size_t blocksX = (width + 3) / 4;
+    size_t blocksY = (height + 3) / 4;
+    size_t tileRowSz = (size_t) (width + 7) / 8 * 32;
+    // Only tiles cut by the image's edges have blocks BC1 doesn't, which decode to nothing visible
+    if (blocksX & 1 || blocksY & 1)
+        memset(dst, 0, TTGX_Size(TXTR_TTF_CMP, width, height));
+    for (size_t by = 0; by < blocksY; by++)
+        for (size_t bx = 0; bx < blocksX; bx++, src += 8)
+            TTDDS_swapBlock(src, &dst[TTDDS_cmpBlock(bx, by, tileRowSz)]);
+}
@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttfs.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <dirent.h>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include <stdext.h>
+
+typedef struct TTFSList {
+    char **paths;
+    size_t count;
+    size_t capacity;
+} TTFSList_t;
+
+FORCE_INLINE bool TTFS_isSep(char c) {
+    return c == '/' || c == '\\';
+}
+
+bool TTFS_HasExt(char *path, char *ext) {
+    size_t pl = strlen(path), el = strlen(ext);
+    if (pl < el)
+        return false;
+    for (size_t i = 0; i < el; i++)
+        if (tolower((unsigned char) path[pl - el + i]) != tolower((unsigned char) ext[i]))
+            return false;
+    return true;
+}
+
+char *TTFS_Join(char *dir, char *name) {
+    size_t dl = strlen(dir);
+    return dl && TTFS_isSep(dir[dl - 1]) ? csprintf_s("%s%s", dir, name) : csprintf_s("%s/%s", dir, name);
+}
+
+char *TTFS_ReplaceExt(char *path, char *ext) {
+    size_t stem = strlen(path);
+    for (size_t i = stem; i > 0; i--) {
+        if (TTFS_isSep(path[i - 1]))
+            break;
+        if (path[i - 1] == '.') {
+            stem = i - 1;
+            break;
+        }
+    }
+    return csprintf_s("%.*s%s", (int) stem, path, ext);
+}
+
+int TTFS_MkDirs(char *path) {
+    char *p = csprintf_s("%s", path);
+    if (!p)
+        return ENOMEM;
+    
+    size_t len = strlen(p);
+    for (size_t i = 1; i <= len; i++) {
+        if (i != len && !TTFS_isSep(p[i]))
+            continue;
+        char c = p[i];
+        p[i] = '\0';
+        bool isDir = false;
+        if (cfexists(p, &isDir)) {
+            if (cmkdir(p) && errno != EEXIST) {
+                int err = errno;
+                free(p);
+                return err;
+            }
+        } else if (!isDir) {
+            free(p);
+            return ENOTDIR;
+        }
+        p[i] = c;
+    }
+    free(p);
+    
+    return 0;
+}
+
+static int TTFS_push(TTFSList_t *list, char *path) {
+    if (list->count == list->capacity) {
+        size_t cap = list->capacity ? list->capacity * 2 : 64;
+        char **paths = realloc(list->paths, sizeof(char *) * cap);
+        if (!paths)
+            return ENOMEM;
+        list->paths = paths;
+        list->capacity = cap;
+    }
+    list->paths[list->count++] = path;
+    return 0;
+}
+
+// Whether path is a symbolic link itself rather than what it points to (Windows has none lstat would see)
+FORCE_INLINE bool TTFS_isLink(char *path) {
+#ifndef _WIN32
+    struct stat st;
+    return !lstat(path, &st) && S_ISLNK(st.st_mode);
+#else
+    FAKEREF(path);
+    return false;
+#endif
+}
+
+// Symlinked directories are not followed so a link back up the tree can't make the walk recurse without end
+static int TTFS_walk(char *root, char *rel, char *ext, TTFSList_t *list) {
+    char *dirPath = *rel ? TTFS_Join(root, rel) : csprintf_s("%s", root);
+    if (!dirPath)
+        return ENOMEM;
+    
+    DIR *dir = opendir(dirPath);
+    if (!dir) {
+        int err = errno;
+        free(dirPath);
+        return err;
+    }
+    
+    int err = 0;
+    struct dirent *ent;
+    while (!err && catexit_loopSafety && (ent = readdir(dir))) {
+        if (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, ".."))
+            continue;
+        
+        char *entRel = *rel ? TTFS_Join(rel, ent->d_name) : csprintf_s("%s", ent->d_name);
+        char *entPath = entRel ? TTFS_Join(dirPath, ent->d_name) : NULL;
+        if (!entRel || !entPath) {
+            free(entRel);
+            err = ENOMEM;
+            break;
+        }
+        
+        bool isDir = false;
+        if (!cfexists(entPath, &isDir)) {
+            if (isDir && TTFS_isLink(entPath))
+                free(entRel);
+            else if (isDir) {
+                err = TTFS_walk(root, entRel, ext, list);
+                free(entRel);
+            } else if (TTFS_HasExt(ent->d_name, ext)) {
+                if ((err = TTFS_push(list, entRel)))
+                    free(entRel);
+            } else
+                free(entRel);
+        } else
+            free(entRel);
+        free(entPath);
+    }
+    closedir(dir);
+    free(dirPath);
+    
+    return err;
+}
+
+static int TTFS_cmpPaths(const void *a, const void *b) {
+    return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+int TTFS_ListFiles(char *root, char *ext, char ***outPaths, size_t *outCount) {
+    TTFSList_t list = { .paths = NULL, .count = 0, .capacity = 0 };
+    int err = TTFS_walk(root, "", ext, &list);
+    if (err) {
+        TTFS_FreeList(list.paths, list.count);
+        return err;
+    }
+    
+    if (list.count)
+        qsort(list.paths, list.count, sizeof(char *), TTFS_cmpPaths);
+    *outPaths = list.paths;
+    *outCount = list.count;
+    return 0;
+}
+
+void TTFS_FreeList(char **paths, size_t count) {
+    if (!paths)
+        return;
+    for (size_t i = 0; i < count; i++)
+        free(paths[i]);
+    free(paths);
+}
@@ -0,0 +1,385 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttgx.h>
+#include <ttisa.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <stdext.h>
+
+typedef struct TTGXTile {
+    uint8_t width;
+    uint8_t height;
+    uint8_t size;
+} TTGXTile_t;
+
+static TTGXTile_t ttgxTiles[TXTR_TTF_CMP + 1] = {
+    [TXTR_TTF_I4] = { .width = 8, .height = 8, .size = 32 },
+    [TXTR_TTF_I8] = { .width = 8, .height = 4, .size = 32 },
+    [TXTR_TTF_IA4] = { .width = 8, .height = 4, .size = 32 },
+    [TXTR_TTF_IA8] = { .width = 4, .height = 4, .size = 32 },
+    [TXTR_TTF_R5G6B5] = { .width = 4, .height = 4, .size = 32 },
+    [TXTR_TTF_RGB5A3] = { .width = 4, .height = 4, .size = 32 },
+    [TXTR_TTF_RGBA8] = { .width = 4, .height = 4, .size = 64 },
+    [TXTR_TTF_CMP] = { .width = 8, .height = 8, .size = 32 }
+};
+
+bool TTGX_CanDecode(TXTRFormat_t fmt) {
+    return fmt >= TXTR_TTF_I4 && fmt <= TXTR_TTF_CMP && ttgxTiles[fmt].size;
+}
+
+size_t TTGX_Size(TXTRFormat_t fmt, uint16_t width, uint16_t height) {
+    TTGXTile_t *tile = &ttgxTiles[fmt];
+    return (size_t) ((width + tile->width - 1) / tile->width) * ((height + tile->height - 1) / tile->height) *
+        tile->size;
+}
+
+// Pixel conversion tasks
+
+FORCE_INLINE uint8_t TTGX_expand3(uint16_t v) {
+    return (uint8_t) ((v << 5) | (v << 2) | (v >> 1));
+}
+
+FORCE_INLINE uint8_t TTGX_expand4(uint16_t v) {
+    return (uint8_t) (v * 0x11);
+}
+
+FORCE_INLINE uint8_t TTGX_expand5(uint16_t v) {
+    return (uint8_t) ((v << 3) | (v >> 2));
+}
+
+FORCE_INLINE uint8_t TTGX_expand6(uint16_t v) {
+    return (uint8_t) ((v << 2) | (v >> 4));
+}
+
+FORCE_INLINE uint16_t TTGX_readBE16(const uint8_t *p) {
+    return (uint16_t) (p[0] << 8 | p[1]);
+}
+
+FORCE_INLINE void TTGX_put(uint8_t *px, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    px[0] = r;
+    px[1] = g;
+    px[2] = b;
+    px[3] = a;
+}
+
+FORCE_INLINE void TTGX_writeBE16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t) (v >> 8);
+    p[1] = (uint8_t) v;
+}
+
+// Baseline kernel tasks
+
+static TTGX_TILES_PROTO(TTGX_i4Tiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        for (size_t y = 0; y < 8; y++) {
+            for (size_t x = 0; x < 8; x++) {
+                // The first pixel of a byte is in the top bits
+                uint8_t v = src[y * 4 + x / 2];
+                uint8_t i = TTGX_expand4(x & 1 ? v & 0x0F : v >> 4);
+                TTGX_put(&dst[y * dstStride + x * 4], i, i, i, i);
+            }
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_i8Tiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        for (size_t y = 0; y < 4; y++) {
+            for (size_t x = 0; x < 8; x++) {
+                uint8_t i = src[y * 8 + x];
+                TTGX_put(&dst[y * dstStride + x * 4], i, i, i, i);
+            }
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_ia4Tiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        for (size_t y = 0; y < 4; y++) {
+            for (size_t x = 0; x < 8; x++) {
+                uint8_t v = src[y * 8 + x];
+                uint8_t i = TTGX_expand4(v & 0x0F);
+                TTGX_put(&dst[y * dstStride + x * 4], i, i, i, TTGX_expand4(v >> 4));
+            }
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_ia8Tiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 4 * 4) {
+        for (size_t y = 0; y < 4; y++) {
+            for (size_t x = 0; x < 4; x++) {
+                const uint8_t *v = &src[(y * 4 + x) * 2];
+                TTGX_put(&dst[y * dstStride + x * 4], v[1], v[1], v[1], v[0]);
+            }
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_r5g6b5Tiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 4 * 4) {
+        for (size_t y = 0; y < 4; y++) {
+            for (size_t x = 0; x < 4; x++) {
+                uint16_t c = TTGX_readBE16(&src[(y * 4 + x) * 2]);
+                TTGX_put(&dst[y * dstStride + x * 4], TTGX_expand5(c >> 11), TTGX_expand6((c >> 5) & 0x3F),
+                    TTGX_expand5(c & 0x1F), 0xFF);
+            }
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_rgb5a3Tiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 4 * 4) {
+        for (size_t y = 0; y < 4; y++) {
+            for (size_t x = 0; x < 4; x++) {
+                // The top bit picks between opaque RGB555 and ARGB3444
+                uint16_t c = TTGX_readBE16(&src[(y * 4 + x) * 2]);
+                uint8_t *px = &dst[y * dstStride + x * 4];
+                if (c & 0x8000)
+                    TTGX_put(px, TTGX_expand5((c >> 10) & 0x1F), TTGX_expand5((c >> 5) & 0x1F),
+                        TTGX_expand5(c & 0x1F), 0xFF);
+                else
+                    TTGX_put(px, TTGX_expand4((c >> 8) & 0x0F), TTGX_expand4((c >> 4) & 0x0F),
+                        TTGX_expand4(c & 0x0F), TTGX_expand3((c >> 12) & 0x07));
+            }
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_rgba8Tiles) {
+    for (size_t t = 0; t < count; t++, src += 64, dst += 4 * 4) {
+        for (size_t y = 0; y < 4; y++) {
+            for (size_t x = 0; x < 4; x++) {
+                const uint8_t *ar = &src[(y * 4 + x) * 2];
+                const uint8_t *gb = &ar[32];
+                TTGX_put(&dst[y * dstStride + x * 4], ar[1], gb[0], gb[1], ar[0]);
+            }
+        }
+    }
+}
+
+// The four RGBA colours of a DXT1 block. The endpoints are big endian 565, the third and fourth colours are 2:1
+// blends of them if the first endpoint is greater and otherwise their average and transparent black.
+static void TTGX_cmpPalette(const uint8_t *blk, uint8_t pal[16]) {
+    uint16_t c0 = TTGX_readBE16(blk);
+    uint16_t c1 = TTGX_readBE16(&blk[2]);
+    uint8_t e[2][3] = {
+        { TTGX_expand5(c0 >> 11), TTGX_expand6((c0 >> 5) & 0x3F), TTGX_expand5(c0 & 0x1F) },
+        { TTGX_expand5(c1 >> 11), TTGX_expand6((c1 >> 5) & 0x3F), TTGX_expand5(c1 & 0x1F) }
+    };
+    for (size_t ch = 0; ch < 3; ch++) {
+        pal[ch] = e[0][ch];
+        pal[4 + ch] = e[1][ch];
+        if (c0 > c1) {
+            pal[8 + ch] = (uint8_t) ((2 * e[0][ch] + e[1][ch]) / 3);
+            pal[12 + ch] = (uint8_t) ((e[0][ch] + 2 * e[1][ch]) / 3);
+        } else {
+            pal[8 + ch] = (uint8_t) ((e[0][ch] + e[1][ch]) / 2);
+            pal[12 + ch] = 0;
+        }
+    }
+    pal[3] = pal[7] = pal[11] = 0xFF;
+    pal[15] = c0 > c1 ? 0xFF : 0;
+}
+
+static void TTGX_cmpBlock(const uint8_t *blk, uint8_t *dst, size_t dstStride) {
+    uint8_t pal[16];
+    TTGX_cmpPalette(blk, pal);
+    for (size_t y = 0; y < 4; y++) {
+        uint8_t row = blk[4 + y];
+        for (size_t x = 0; x < 4; x++)
+            memcpy(&dst[y * dstStride + x * 4], &pal[((row >> (6 - 2 * x)) & 3) * 4], 4);
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_cmpTiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        TTGX_cmpBlock(src, dst, dstStride);
+        TTGX_cmpBlock(&src[8], &dst[4 * 4], dstStride);
+        TTGX_cmpBlock(&src[16], &dst[4 * dstStride], dstStride);
+        TTGX_cmpBlock(&src[24], &dst[4 * dstStride + 4 * 4], dstStride);
+    }
+}
+
+const TTGXTiles_t TTGX_DecodeTiles_baseline[TXTR_TTF_CMP + 1] = {
+    [TXTR_TTF_I4] = TTGX_i4Tiles,
+    [TXTR_TTF_I8] = TTGX_i8Tiles,
+    [TXTR_TTF_IA4] = TTGX_ia4Tiles,
+    [TXTR_TTF_IA8] = TTGX_ia8Tiles,
+    [TXTR_TTF_R5G6B5] = TTGX_r5g6b5Tiles,
+    [TXTR_TTF_RGB5A3] = TTGX_rgb5a3Tiles,
+    [TXTR_TTF_RGBA8] = TTGX_rgba8Tiles,
+    [TXTR_TTF_CMP] = TTGX_cmpTiles
+};
+
+// Decode tasks
+
+static const TTGXTiles_t *TTGX_kernels(TTISA_t isa) {
+    switch (isa) {
+#ifdef TXTRTOOL_ISA_DISPATCH
+        case TTISA_AVX2:
+            return TTGX_DecodeTiles_avx2;
+        case TTISA_AVX:
+            return TTGX_DecodeTiles_avx;
+        case TTISA_SSE2:
+            return TTGX_DecodeTiles_sse2;
+#endif
+        default:
+            return TTGX_DecodeTiles_baseline;
+    }
+}
+
+// Decodes the w x h rectangle at x, y of a width pixels wide image into w * h pixels. Only the tiles the rectangle
+// touches are read. Runs of tiles it covers whole are decoded straight into dst and the ones it cuts (including those
+// hanging over the right or bottom edge of the image) are decoded to the side and only their part is copied.
+static void TTGX_decode(TTGXTiles_t tiles, TTGXTile_t *tile, const uint8_t *src, uint16_t width, uint16_t x,
+uint16_t y, uint16_t w, uint16_t h, uint8_t *dst) {
+    size_t rowSz = (width + tile->width - 1) / tile->width * tile->size;
+    size_t stride = (size_t) w * 4;
+    size_t tileStride = (size_t) tile->width * 4;
+    size_t right = (size_t) x + w;
+    size_t bottom = (size_t) y + h;
+    size_t firstX = x / tile->width;
+    size_t endX = (right + tile->width - 1) / tile->width;
+    size_t fullX = (x + tile->width - 1) / tile->width;
+    size_t fullEndX = right / tile->width;
+    for (size_t ty = y / tile->height; ty * tile->height < bottom; ty++) {
+        const uint8_t *row = &src[ty * rowSz];
+        size_t py = ty * tile->height;
+        size_t top = py > y ? py : y;
+        size_t end = py + tile->height < bottom ? py + tile->height : bottom;
+        uint8_t *out = &dst[(top - y) * stride];
+        bool wholeRows = top == py && end == py + tile->height;
+        for (size_t tx = firstX; tx < endX; tx++) {
+            size_t px = tx * tile->width;
+            if (wholeRows && tx == fullX && fullEndX > fullX) {
+                tiles(&row[tx * tile->size], fullEndX - fullX, &out[(px - x) * 4], stride);
+                tx = fullEndX - 1;
+                continue;
+            }
+            
+            uint8_t scratch[8 * 8 * 4];
+            tiles(&row[tx * tile->size], 1, scratch, tileStride);
+            size_t left = px > x ? px : x;
+            size_t cols = (px + tile->width < right ? px + tile->width : right) - left;
+            for (size_t r = top; r < end; r++)
+                memcpy(&out[(r - top) * stride + (left - x) * 4], &scratch[(r - py) * tileStride + (left - px) * 4],
+                    cols * 4);
+        }
+    }
+}
+
+void TTGX_Decode(TXTRFormat_t fmt, const uint8_t *src, uint16_t width, uint16_t height, uint8_t *dst) {
+    TTGX_decode(TTGX_kernels(TTISA_Active())[fmt], &ttgxTiles[fmt], src, width, 0, 0, width, height, dst);
+}
+
+void TTGX_DecodeRect(TXTRFormat_t fmt, const uint8_t *src, uint16_t width, uint16_t x, uint16_t y, uint16_t w,
+uint16_t h, uint8_t *dst) {
+    TTGX_decode(TTGX_kernels(TTISA_Active())[fmt], &ttgxTiles[fmt], src, width, x, y, w, h, dst);
+}
+
+// Fills src with the texels TTGX_Check decodes (see its description)
+static void TTGX_checkTexels(TXTRFormat_t fmt, uint8_t *src, size_t srcSz) {
+    if (fmt == TXTR_TTF_RGBA8) {
+        // Byte i of every 64 byte tile takes each value in turn
+        for (size_t i = 0; i < srcSz; i++)
+            src[i] = (uint8_t) (i / 64 + i);
+    } else if (fmt == TXTR_TTF_CMP) {
+        // Every block's rows hold each index once, rotated so each pixel gets every index over four blocks. Its
+        // endpoints go over every pair of values of one channel with the others picking the mode: green in both
+        // modes, red (which decides the mode itself), blue in both modes. Random blocks fill the rest.
+        static const uint8_t rows[4] = { 0x1B, 0x4E, 0xB1, 0xE4 };
+        uint32_t state = 0x9E3779B9;
+        for (size_t blk = 0; blk < srcSz / 8; blk++) {
+            uint8_t *b = &src[blk * 8];
+            uint16_t c0, c1;
+            if (blk < 8192) {
+                uint16_t mode = (uint16_t) (blk >> 12);
+                c0 = (uint16_t) (!mode << 11 | (blk & 63) << 5);
+                c1 = (uint16_t) (mode << 11 | (blk >> 6 & 63) << 5);
+            } else if (blk < 9216) {
+                c0 = (uint16_t) ((blk & 31) << 11);
+                c1 = (uint16_t) ((blk >> 5 & 31) << 11);
+            } else if (blk < 11264) {
+                uint16_t mode = (uint16_t) ((blk - 9216) >> 10);
+                c0 = (uint16_t) (!mode << 11 | (blk & 31));
+                c1 = (uint16_t) (mode << 11 | (blk >> 5 & 31));
+            } else {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                c0 = (uint16_t) state;
+                c1 = (uint16_t) (state >> 16);
+            }
+            TTGX_writeBE16(b, c0);
+            TTGX_writeBE16(&b[2], c1);
+            for (size_t y = 0; y < 4; y++)
+                b[4 + y] = rows[(blk + y) % 4];
+        }
+    } else {
+        // Every 16 bit value once, and 8 and 4 bit ones many times over
+        for (size_t i = 0; i < srcSz; i += 2)
+            TTGX_writeBE16(&src[i], (uint16_t) (i / 2));
+    }
+}
+
+int TTGX_Check(TXTRFormat_t fmt, bool *outSame) {
+    if (!TTGX_CanDecode(fmt))
+        return EINVAL;
+    
+    // 256x256 images hold every 16 bit value once and 512x512 CMP ones 16384 blocks, room for all of its endpoint
+    // pairs. Decoding 6 pixels less adds tiles cut off at the edges.
+    uint16_t side = fmt == TXTR_TTF_CMP ? 512 : 256;
+    uint16_t sizes[2] = { side, (uint16_t) (side - 6) };
+    size_t srcSz = TTGX_Size(fmt, side, side);
+    uint8_t *src = malloc(srcSz);
+    uint8_t *want = malloc((size_t) side * side * 4);
+    uint8_t *got = malloc((size_t) side * side * 4);
+    if (!src || !want || !got) {
+        free(src);
+        free(want);
+        free(got);
+        return ENOMEM;
+    }
+    TTGX_checkTexels(fmt, src, srcSz);
+    
+    TTGXTiles_t base = TTGX_DecodeTiles_baseline[fmt];
+    TTGXTiles_t active = TTGX_kernels(TTISA_Active())[fmt];
+    *outSame = true;
+    for (size_t s = 0; s < 2 && *outSame; s++) {
+        size_t pxSz = (size_t) sizes[s] * sizes[s] * 4;
+        TTGX_decode(base, &ttgxTiles[fmt], src, sizes[s], 0, 0, sizes[s], sizes[s], want);
+        TTGX_decode(active, &ttgxTiles[fmt], src, sizes[s], 0, 0, sizes[s], sizes[s], got);
+        *outSame = !memcmp(want, got, pxSz);
+    }
+    free(src);
+    free(want);
+    free(got);
+    
+    return 0;
+}
@@ -0,0 +1,348 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Built once per instruction set (see CMakeLists.txt) with TXTRTOOL_ISA set to sse2, avx or avx2 and the matching -m
+// flag. Every build shares the 128 bit kernels (the avx ones just get VEX encodings) and avx2 replaces CMP's with a
+// 256 bit one. The kernels must give exactly what the baseline ones in src/ttgx.c do, which TTGX_Check verifies.
+
+#ifndef TXTRTOOL_ISA
+#error TXTRTOOL_ISA must be defined
+#endif
+
+#include <ttgx.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include <stdext.h>
+
+#define TTGX_sse2 1
+#define TTGX_avx 2
+#define TTGX_avx2 3
+#define TTGX_CAT(a, b) a ## b
+#define TTGX_XCAT(a, b) TTGX_CAT(a, b)
+#define TTGX_LEVEL TTGX_XCAT(TTGX_, TXTRTOOL_ISA)
+
+#if TTGX_LEVEL != TTGX_sse2 && TTGX_LEVEL != TTGX_avx && TTGX_LEVEL != TTGX_avx2
+#error Unknown TXTRTOOL_ISA
+#endif
+
+FORCE_INLINE int TTGX_load32(const uint8_t *p) {
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+FORCE_INLINE __m128i TTGX_load64(const uint8_t *p) {
+    return _mm_loadl_epi64((const __m128i *) p);
+}
+
+FORCE_INLINE __m128i TTGX_load128(const uint8_t *p) {
+    return _mm_loadu_si128((const __m128i *) p);
+}
+
+FORCE_INLINE void TTGX_store128(uint8_t *p, __m128i v) {
+    _mm_storeu_si128((__m128i *) p, v);
+}
+
+FORCE_INLINE __m128i TTGX_select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Big endian 16 bit values to native ones
+FORCE_INLINE __m128i TTGX_swap16(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+// Bit expansion of values in 32 bit lanes
+FORCE_INLINE __m128i TTGX_expand3(__m128i v) {
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(v, 5), _mm_slli_epi32(v, 2)), _mm_srli_epi32(v, 1));
+}
+
+FORCE_INLINE __m128i TTGX_expand4(__m128i v) {
+    return _mm_or_si128(v, _mm_slli_epi32(v, 4));
+}
+
+FORCE_INLINE __m128i TTGX_expand5(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi32(v, 3), _mm_srli_epi32(v, 2));
+}
+
+FORCE_INLINE __m128i TTGX_expand6(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi32(v, 2), _mm_srli_epi32(v, 4));
+}
+
+// Bit expansion of nibbles in 8 bit lanes (shifting 16 bit lanes can't carry between bytes since the top bits are 0)
+FORCE_INLINE __m128i TTGX_expand4x8(__m128i v) {
+    return _mm_or_si128(v, _mm_slli_epi16(v, 4));
+}
+
+FORCE_INLINE __m128i TTGX_bits(__m128i v, int shift, int mask) {
+    return _mm_and_si128(_mm_srli_epi32(v, shift), _mm_set1_epi32(mask));
+}
+
+FORCE_INLINE __m128i TTGX_rgba(__m128i r, __m128i g, __m128i b, __m128i a) {
+    return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16),
+        _mm_slli_epi32(a, 24)));
+}
+
+// Intensity bytes to pixels of four copies of them, 16 bytes make 4 rows of 16 bytes
+FORCE_INLINE void TTGX_splat(__m128i i, __m128i px[4]) {
+    __m128i lo = _mm_unpacklo_epi8(i, i);
+    __m128i hi = _mm_unpackhi_epi8(i, i);
+    px[0] = _mm_unpacklo_epi16(lo, lo);
+    px[1] = _mm_unpackhi_epi16(lo, lo);
+    px[2] = _mm_unpacklo_epi16(hi, hi);
+    px[3] = _mm_unpackhi_epi16(hi, hi);
+}
+
+// Pixel kernel tasks (two rows at a time)
+
+static TTGX_TILES_PROTO(TTGX_i4Tiles) {
+    __m128i m4 = _mm_set1_epi8(0x0F);
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        for (size_t y = 0; y < 8; y += 2) {
+            // The first pixel of a byte is in the top bits
+            __m128i v = TTGX_load64(&src[y * 4]);
+            __m128i n = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(v, 4), m4), _mm_and_si128(v, m4));
+            __m128i px[4];
+            TTGX_splat(TTGX_expand4x8(n), px);
+            TTGX_store128(&dst[y * dstStride], px[0]);
+            TTGX_store128(&dst[y * dstStride + 16], px[1]);
+            TTGX_store128(&dst[(y + 1) * dstStride], px[2]);
+            TTGX_store128(&dst[(y + 1) * dstStride + 16], px[3]);
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_i8Tiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        for (size_t y = 0; y < 4; y += 2) {
+            __m128i px[4];
+            TTGX_splat(TTGX_load128(&src[y * 8]), px);
+            TTGX_store128(&dst[y * dstStride], px[0]);
+            TTGX_store128(&dst[y * dstStride + 16], px[1]);
+            TTGX_store128(&dst[(y + 1) * dstStride], px[2]);
+            TTGX_store128(&dst[(y + 1) * dstStride + 16], px[3]);
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_ia4Tiles) {
+    __m128i m4 = _mm_set1_epi8(0x0F);
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        for (size_t y = 0; y < 4; y += 2) {
+            __m128i v = TTGX_load128(&src[y * 8]);
+            __m128i i = TTGX_expand4x8(_mm_and_si128(v, m4));
+            __m128i a = TTGX_expand4x8(_mm_and_si128(_mm_srli_epi16(v, 4), m4));
+            // I, I then I, A byte pairs interleaved make I, I, I, A
+            __m128i iiLo = _mm_unpacklo_epi8(i, i), iaLo = _mm_unpacklo_epi8(i, a);
+            __m128i iiHi = _mm_unpackhi_epi8(i, i), iaHi = _mm_unpackhi_epi8(i, a);
+            TTGX_store128(&dst[y * dstStride], _mm_unpacklo_epi16(iiLo, iaLo));
+            TTGX_store128(&dst[y * dstStride + 16], _mm_unpackhi_epi16(iiLo, iaLo));
+            TTGX_store128(&dst[(y + 1) * dstStride], _mm_unpacklo_epi16(iiHi, iaHi));
+            TTGX_store128(&dst[(y + 1) * dstStride + 16], _mm_unpackhi_epi16(iiHi, iaHi));
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_ia8Tiles) {
+    __m128i m8 = _mm_set1_epi16(0xFF);
+    for (size_t t = 0; t < count; t++, src += 32, dst += 4 * 4) {
+        for (size_t y = 0; y < 4; y += 2) {
+            // Pairs are A, I in memory so I is the top byte of each 16 bit lane
+            __m128i v = TTGX_load128(&src[y * 8]);
+            __m128i i = _mm_srli_epi16(v, 8);
+            __m128i ii = _mm_or_si128(i, _mm_slli_epi16(i, 8));
+            __m128i ia = _mm_or_si128(i, _mm_slli_epi16(_mm_and_si128(v, m8), 8));
+            TTGX_store128(&dst[y * dstStride], _mm_unpacklo_epi16(ii, ia));
+            TTGX_store128(&dst[(y + 1) * dstStride], _mm_unpackhi_epi16(ii, ia));
+        }
+    }
+}
+
+FORCE_INLINE __m128i TTGX_r5g6b5(__m128i c) {
+    return TTGX_rgba(TTGX_expand5(TTGX_bits(c, 11, 0x1F)), TTGX_expand6(TTGX_bits(c, 5, 0x3F)),
+        TTGX_expand5(TTGX_bits(c, 0, 0x1F)), _mm_set1_epi32(0xFF));
+}
+
+static TTGX_TILES_PROTO(TTGX_r5g6b5Tiles) {
+    __m128i zero = _mm_setzero_si128();
+    for (size_t t = 0; t < count; t++, src += 32, dst += 4 * 4) {
+        for (size_t y = 0; y < 4; y += 2) {
+            __m128i c = TTGX_swap16(TTGX_load128(&src[y * 8]));
+            TTGX_store128(&dst[y * dstStride], TTGX_r5g6b5(_mm_unpacklo_epi16(c, zero)));
+            TTGX_store128(&dst[(y + 1) * dstStride], TTGX_r5g6b5(_mm_unpackhi_epi16(c, zero)));
+        }
+    }
+}
+
+// Both of RGB5A3's modes are converted and the top bit of each pixel picks one
+FORCE_INLINE __m128i TTGX_rgb5a3(__m128i c) {
+    __m128i opaque = _mm_cmpgt_epi32(c, _mm_set1_epi32(0x7FFF));
+    __m128i r = TTGX_select(opaque, TTGX_expand5(TTGX_bits(c, 10, 0x1F)), TTGX_expand4(TTGX_bits(c, 8, 0x0F)));
+    __m128i g = TTGX_select(opaque, TTGX_expand5(TTGX_bits(c, 5, 0x1F)), TTGX_expand4(TTGX_bits(c, 4, 0x0F)));
+    __m128i b = TTGX_select(opaque, TTGX_expand5(TTGX_bits(c, 0, 0x1F)), TTGX_expand4(TTGX_bits(c, 0, 0x0F)));
+    __m128i a = TTGX_select(opaque, _mm_set1_epi32(0xFF), TTGX_expand3(TTGX_bits(c, 12, 0x07)));
+    return TTGX_rgba(r, g, b, a);
+}
+
+static TTGX_TILES_PROTO(TTGX_rgb5a3Tiles) {
+    __m128i zero = _mm_setzero_si128();
+    for (size_t t = 0; t < count; t++, src += 32, dst += 4 * 4) {
+        for (size_t y = 0; y < 4; y += 2) {
+            __m128i c = TTGX_swap16(TTGX_load128(&src[y * 8]));
+            TTGX_store128(&dst[y * dstStride], TTGX_rgb5a3(_mm_unpacklo_epi16(c, zero)));
+            TTGX_store128(&dst[(y + 1) * dstStride], TTGX_rgb5a3(_mm_unpackhi_epi16(c, zero)));
+        }
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_rgba8Tiles) {
+    __m128i m8 = _mm_set1_epi16(0xFF);
+    for (size_t t = 0; t < count; t++, src += 64, dst += 4 * 4) {
+        for (size_t y = 0; y < 4; y += 2) {
+            // The AR and GB planes are rejoined into R, G and B, A byte pairs
+            __m128i ar = TTGX_load128(&src[y * 8]);
+            __m128i gb = TTGX_load128(&src[32 + y * 8]);
+            __m128i rg = _mm_or_si128(_mm_srli_epi16(ar, 8), _mm_slli_epi16(_mm_and_si128(gb, m8), 8));
+            __m128i ba = _mm_or_si128(_mm_srli_epi16(gb, 8), _mm_slli_epi16(_mm_and_si128(ar, m8), 8));
+            TTGX_store128(&dst[y * dstStride], _mm_unpacklo_epi16(rg, ba));
+            TTGX_store128(&dst[(y + 1) * dstStride], _mm_unpackhi_epi16(rg, ba));
+        }
+    }
+}
+
+// CMP kernel tasks
+
+// x / 3 for x up to 766 in the low 16 bits of every 32 bit lane
+FORCE_INLINE __m128i TTGX_div3(__m128i x) {
+    return _mm_mulhi_epu16(x, _mm_set1_epi16(0x5556));
+}
+
+// The third and fourth colour of one channel of four blocks (see TTGX_cmpPalette in src/ttgx.c)
+FORCE_INLINE void TTGX_blend(__m128i gt, __m128i a, __m128i b, __m128i *c2, __m128i *c3) {
+    __m128i ab = _mm_add_epi32(a, b);
+    *c2 = TTGX_select(gt, TTGX_div3(_mm_add_epi32(ab, a)), _mm_srli_epi32(ab, 1));
+    *c3 = _mm_and_si128(gt, TTGX_div3(_mm_add_epi32(ab, b)));
+}
+
+// The palettes of the four blocks of a tile with one vector per colour index and one RGBA lane per block
+FORCE_INLINE void TTGX_cmpPalettes(const uint8_t *src, __m128i pal[4]) {
+    // Each lane is the block's two big endian endpoints, byte swapping every 16 bits leaves c1 << 16 | c0
+    __m128i e = TTGX_swap16(_mm_setr_epi32(TTGX_load32(src), TTGX_load32(&src[8]), TTGX_load32(&src[16]),
+        TTGX_load32(&src[24])));
+    __m128i c0 = _mm_and_si128(e, _mm_set1_epi32(0xFFFF));
+    __m128i c1 = _mm_srli_epi32(e, 16);
+    __m128i gt = _mm_cmpgt_epi32(c0, c1);
+    
+    __m128i r0 = TTGX_expand5(TTGX_bits(c0, 11, 0x1F)), r1 = TTGX_expand5(TTGX_bits(c1, 11, 0x1F));
+    __m128i g0 = TTGX_expand6(TTGX_bits(c0, 5, 0x3F)), g1 = TTGX_expand6(TTGX_bits(c1, 5, 0x3F));
+    __m128i b0 = TTGX_expand5(TTGX_bits(c0, 0, 0x1F)), b1 = TTGX_expand5(TTGX_bits(c1, 0, 0x1F));
+    __m128i r2, r3, g2, g3, b2, b3;
+    TTGX_blend(gt, r0, r1, &r2, &r3);
+    TTGX_blend(gt, g0, g1, &g2, &g3);
+    TTGX_blend(gt, b0, b1, &b2, &b3);
+    
+    __m128i opaque = _mm_set1_epi32(0xFF);
+    pal[0] = TTGX_rgba(r0, g0, b0, opaque);
+    pal[1] = TTGX_rgba(r1, g1, b1, opaque);
+    pal[2] = TTGX_rgba(r2, g2, b2, opaque);
+    pal[3] = TTGX_rgba(r3, g3, b3, _mm_and_si128(gt, opaque));
+}
+
+#if TTGX_LEVEL == TTGX_avx2
+// Rows of a block pair's indices are shifted apart per pixel and looked up in both blocks' palettes at once, so a
+// whole 8 pixel tile row is one permute
+FORCE_INLINE void TTGX_cmpBlockPair(const uint8_t *src, __m256i pal, uint8_t *dst, size_t dstStride) {
+    __m256i shifts = _mm256_setr_epi32(6, 4, 2, 0, 6, 4, 2, 0);
+    __m256i right = _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4);
+    __m256i three = _mm256_set1_epi32(3);
+    for (size_t y = 0; y < 4; y++) {
+        __m256i rows = _mm256_setr_epi32(src[4 + y], src[4 + y], src[4 + y], src[4 + y], src[12 + y], src[12 + y],
+            src[12 + y], src[12 + y]);
+        __m256i idx = _mm256_add_epi32(_mm256_and_si256(_mm256_srlv_epi32(rows, shifts), three), right);
+        _mm256_storeu_si256((__m256i *) &dst[y * dstStride], _mm256_permutevar8x32_epi32(pal, idx));
+    }
+}
+
+static TTGX_TILES_PROTO(TTGX_cmpTiles) {
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        __m128i pal[4];
+        TTGX_cmpPalettes(src, pal);
+        
+        // Transpose to one vector of four colours per block
+        __m128i lo01 = _mm_unpacklo_epi32(pal[0], pal[1]), hi01 = _mm_unpackhi_epi32(pal[0], pal[1]);
+        __m128i lo23 = _mm_unpacklo_epi32(pal[2], pal[3]), hi23 = _mm_unpackhi_epi32(pal[2], pal[3]);
+        __m128i blk0 = _mm_unpacklo_epi64(lo01, lo23), blk1 = _mm_unpackhi_epi64(lo01, lo23);
+        __m128i blk2 = _mm_unpacklo_epi64(hi01, hi23), blk3 = _mm_unpackhi_epi64(hi01, hi23);
+        
+        TTGX_cmpBlockPair(src, _mm256_inserti128_si256(_mm256_castsi128_si256(blk0), blk1, 1), dst, dstStride);
+        TTGX_cmpBlockPair(&src[16], _mm256_inserti128_si256(_mm256_castsi128_si256(blk2), blk3, 1),
+            &dst[4 * dstStride], dstStride);
+    }
+}
+#else
+// Every pixel of a row is masked to its own index bits and compared against each index to pick its colour
+#define TTGX_CMPBLOCK(blk, ox, oy) do { \
+        __m128i p0 = _mm_shuffle_epi32(pal[0], _MM_SHUFFLE(blk, blk, blk, blk)); \
+        __m128i p1 = _mm_shuffle_epi32(pal[1], _MM_SHUFFLE(blk, blk, blk, blk)); \
+        __m128i p2 = _mm_shuffle_epi32(pal[2], _MM_SHUFFLE(blk, blk, blk, blk)); \
+        __m128i p3 = _mm_shuffle_epi32(pal[3], _MM_SHUFFLE(blk, blk, blk, blk)); \
+        for (size_t y = 0; y < 4; y++) { \
+            __m128i v = _mm_and_si128(_mm_set1_epi32(src[(blk) * 8 + 4 + y]), mask); \
+            __m128i px = _mm_and_si128(_mm_cmpeq_epi32(v, _mm_setzero_si128()), p0); \
+            px = _mm_or_si128(px, _mm_and_si128(_mm_cmpeq_epi32(v, idx1), p1)); \
+            px = _mm_or_si128(px, _mm_and_si128(_mm_cmpeq_epi32(v, idx2), p2)); \
+            px = _mm_or_si128(px, _mm_and_si128(_mm_cmpeq_epi32(v, mask), p3)); \
+            TTGX_store128(&dst[((oy) + y) * dstStride + (ox) * 4], px); \
+        } \
+    } while (0)
+
+static TTGX_TILES_PROTO(TTGX_cmpTiles) {
+    __m128i mask = _mm_setr_epi32(0xC0, 0x30, 0x0C, 0x03);
+    __m128i idx1 = _mm_setr_epi32(0x40, 0x10, 0x04, 0x01);
+    __m128i idx2 = _mm_setr_epi32(0x80, 0x20, 0x08, 0x02);
+    for (size_t t = 0; t < count; t++, src += 32, dst += 8 * 4) {
+        __m128i pal[4];
+        TTGX_cmpPalettes(src, pal);
+        TTGX_CMPBLOCK(0, 0, 0);
+        TTGX_CMPBLOCK(1, 4, 0);
+        TTGX_CMPBLOCK(2, 0, 4);
+        TTGX_CMPBLOCK(3, 4, 4);
+    }
+}
+#undef TTGX_CMPBLOCK
+#endif
+
+const TTGXTiles_t TTGX_XCAT(TTGX_DecodeTiles_, TXTRTOOL_ISA)[TXTR_TTF_CMP + 1] = {
+    [TXTR_TTF_I4] = TTGX_i4Tiles,
+    [TXTR_TTF_I8] = TTGX_i8Tiles,
+    [TXTR_TTF_IA4] = TTGX_ia4Tiles,
+    [TXTR_TTF_IA8] = TTGX_ia8Tiles,
+    [TXTR_TTF_R5G6B5] = TTGX_r5g6b5Tiles,
+    [TXTR_TTF_RGB5A3] = TTGX_rgb5a3Tiles,
+    [TXTR_TTF_RGBA8] = TTGX_rgba8Tiles,
+    [TXTR_TTF_CMP] = TTGX_cmpTiles
+};
@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttinfo.h>
+
+#include <stdio.h>
+#include <errno.h>
+
+#include <stdext.h>
+
+static char *_TTInfoError_ToStr[5] = {
+    [TTI_E_SUCCESS] = "Success",
+    [TTI_E_IO] = "Failed to read the file",
+    [TTI_E_TRUNCATED] = "File is too small to hold a TXTR header",
+    [TTI_E_INVLDTEXFMT] = "Invalid texture format",
+    [TTI_E_INVLDPALFMT] = "Invalid palette format"
+};
+
+FORCE_INLINE uint16_t TTInfo_readBE16(uint8_t *p) {
+    return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+FORCE_INLINE uint32_t TTInfo_readBE32(uint8_t *p) {
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+char *TTInfoError_ToStr(TTInfoError_t e) {
+    return e >= TTI_E_SUCCESS && e <= TTI_E_INVLDPALFMT ? _TTInfoError_ToStr[e] : "Unknown error";
+}
+
+TTInfoError_t TTInfo_Parse(TTInfo_t *info, size_t size, uint8_t *data) {
+    if (size < TTINFO_HDRSZ)
+        return TTI_E_TRUNCATED;
+    
+    uint32_t format = TTInfo_readBE32(&data[0]);
+    if (format > TXTR_TTF_CMP)
+        return TTI_E_INVLDTEXFMT;
+    info->hdr.format = (TXTRFormat_t) format;
+    info->hdr.width = TTInfo_readBE16(&data[4]);
+    info->hdr.height = TTInfo_readBE16(&data[6]);
+    info->hdr.mipCount = TTInfo_readBE32(&data[8]);
+    info->isIndexed = TXTR_IsIndexed(info->hdr.format);
+    info->palHdr.format = TXTR_TPF_INVALID;
+    info->palHdr.width = 0;
+    info->palHdr.height = 0;
+    if (!info->isIndexed)
+        return TTI_E_SUCCESS;
+    
+    if (size < TTINFO_HDRSZ + TTINFO_PALHDRSZ)
+        return TTI_E_TRUNCATED;
+    uint32_t palFormat = TTInfo_readBE32(&data[TTINFO_HDRSZ]);
+    if (palFormat > TXTR_TPF_RGB5A3)
+        return TTI_E_INVLDPALFMT;
+    info->palHdr.format = (TXTRPaletteFormat_t) palFormat;
+    info->palHdr.width = TTInfo_readBE16(&data[TTINFO_HDRSZ + 4]);
+    info->palHdr.height = TTInfo_readBE16(&data[TTINFO_HDRSZ + 6]);
+    return TTI_E_SUCCESS;
+}
+
+TTInfoError_t TTInfo_Read(TTInfo_t *info, char *path) {
+    FILE *file;
+    if (cfopen(path, "rb", &file))
+        return TTI_E_IO;
+    // Without a buffer stdio reads only what is asked for instead of a whole block
+    setvbuf(file, NULL, _IONBF, 0);
+    
+    size_t fileSz = 0;
+    if (cfsize(&fileSz, file)) {
+        int err = errno;
+        cfclose(file);
+        errno = err;
+        return TTI_E_IO;
+    }
+    
+    uint8_t hdr[TTINFO_HDRSZ + TTINFO_PALHDRSZ];
+    size_t hdrSz = fileSz < sizeof(hdr) ? fileSz : sizeof(hdr);
+    if (hdrSz && cfread(hdr, sizeof(uint8_t), hdrSz, file)) {
+        int err = errno;
+        cfclose(file);
+        errno = err;
+        return TTI_E_IO;
+    }
+    cfclose(file);
+    
+    info->fileSz = fileSz;
+    return TTInfo_Parse(info, hdrSz, hdr);
+}
@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttio.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+#include <stdext.h>
+
+#ifdef _WIN32
+int TTIO_WriteFile(char *path, TTIOVec_t *vecs, size_t vecCount) {
+    FILE *file;
+    if (cfopen(path, "wb", &file))
+        return errno;
+    
+    for (size_t v = 0; v < vecCount; v++) {
+        if (vecs[v].size && cfwrite(vecs[v].data, sizeof(uint8_t), vecs[v].size, file)) {
+            int err = errno;
+            cfclose(file);
+            return err;
+        }
+    }
+    return cfclose(file) ? errno : 0;
+}
+#else
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+
+int TTIO_WriteFile(char *path, TTIOVec_t *vecs, size_t vecCount) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd == -1)
+        return errno;
+    
+    // Partial writes leave off anywhere so v and done track where the next writev picks up from
+    struct iovec iov[IOV_MAX];
+    size_t v = 0, done = 0;
+    while (v < vecCount) {
+        int iovCount = 0;
+        for (size_t i = v; i < vecCount && iovCount < IOV_MAX; i++) {
+            size_t skip = i == v ? done : 0;
+            if (vecs[i].size == skip)
+                continue;
+            iov[iovCount].iov_base = (uint8_t *) vecs[i].data + skip;
+            iov[iovCount].iov_len = vecs[i].size - skip;
+            iovCount++;
+        }
+        if (!iovCount)
+            break;
+        
+        ssize_t wrote = writev(fd, iov, iovCount);
+        if (wrote < 0) {
+            if (errno == EINTR)
+                continue;
+            int err = errno;
+            close(fd);
+            return err;
+        }
+        
+        size_t left = (size_t) wrote;
+        while (v < vecCount && left >= vecs[v].size - done) {
+            left -= vecs[v].size - done;
+            done = 0;
+            v++;
+        }
+        done += left;
+    }
+    return close(fd) ? errno : 0;
+}
+#endif
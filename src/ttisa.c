@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttisa.h>
+
+#include <string.h>
+
+static char *_TTISA_ToStr[4] = {
+    [TTISA_BASELINE] = "baseline",
+    [TTISA_SSE2] = "sse2",
+    [TTISA_AVX] = "avx",
+    [TTISA_AVX2] = "avx2"
+};
+
+static TTISA_t ttISAActive = TTISA_BASELINE;
+
+char *TTISA_ToStr(TTISA_t isa) {
+    return isa >= TTISA_MIN && isa <= TTISA_MAX ? _TTISA_ToStr[isa] : "invalid";
+}
+
+TTISA_t TTISA_FromStr(char *str) {
+    for (TTISA_t isa = TTISA_MIN; isa <= TTISA_MAX; isa++)
+        if (!strcmp(str, TTISA_ToStr(isa)))
+            return isa;
+    return TTISA_INVALID;
+}
+
+bool TTISA_Supported(TTISA_t isa) {
+    if (isa == TTISA_BASELINE)
+        return true;
+#if defined(TXTRTOOL_ISA_DISPATCH) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    switch (isa) {
+        case TTISA_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case TTISA_AVX:
+            return __builtin_cpu_supports("avx");
+        case TTISA_AVX2:
+            return __builtin_cpu_supports("avx2");
+        default:
+            return false;
+    }
+#else
+    return false;
+#endif
+}
+
+TTISA_t TTISA_Detect(void) {
+    TTISA_t isa = TTISA_MAX;
+    while (isa > TTISA_BASELINE && !TTISA_Supported(isa))
+        isa--;
+    return isa;
+}
+
+bool TTISA_Select(TTISA_t isa) {
+    if (isa < TTISA_MIN || isa > TTISA_MAX || !TTISA_Supported(isa))
+        return false;
+    ttISAActive = isa;
+    return true;
+}
+
+TTISA_t TTISA_Active(void) {
+    return ttISAActive;
+}
@@ -0,0 +1,352 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <ttjson.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <stdext.h>
+
+FORCE_INLINE char *TTJSON_skipSpace(char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        p++;
+    return p;
+}
+
+static int TTJSON_hex(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// Unescapes the string starting after the opening quote at p into itself and returns the character after the closing
+// quote, or NULL if the string is malformed. The unescaped text is never longer so it is terminated where the closing
+// quote was at the latest.
+static char *TTJSON_string(char *p) {
+    char *out = p;
+    while (*p != '"') {
+        unsigned char ch = (unsigned char) *p++;
+        if (!ch || ch < 0x20)
+            return NULL;
+        if (ch != '\\') {
+            *out++ = (char) ch;
+            continue;
+        }
+        
+        switch (*p++) {
+            case '"':
+                *out++ = '"';
+                break;
+            case '\\':
+                *out++ = '\\';
+                break;
+            case '/':
+                *out++ = '/';
+                break;
+            case 'b':
+                *out++ = '\b';
+                break;
+            case 'f':
+                *out++ = '\f';
+                break;
+            case 'n':
+                *out++ = '\n';
+                break;
+            case 'r':
+                *out++ = '\r';
+                break;
+            case 't':
+                *out++ = '\t';
+                break;
+            case 'u': {
+                uint32_t cp = 0;
+                for (size_t i = 0; i < 4; i++) {
+                    int h = TTJSON_hex(*p++);
+                    if (h < 0)
+                        return NULL;
+                    cp = cp << 4 | (uint32_t) h;
+                }
+                
+                // Surrogate pairs make one code point out of two escapes
+                if (cp >= 0xD800 && cp < 0xDC00) {
+                    if (p[0] != '\\' || p[1] != 'u')
+                        return NULL;
+                    p += 2;
+                    uint32_t lo = 0;
+                    for (size_t i = 0; i < 4; i++) {
+                        int h = TTJSON_hex(*p++);
+                        if (h < 0)
+                            return NULL;
+                        lo = lo << 4 | (uint32_t) h;
+                    }
+                    if (lo < 0xDC00 || lo >= 0xE000)
+                        return NULL;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                } else if (cp >= 0xDC00 && cp < 0xE000)
+                    return NULL;
+                
+                // Never longer than the escape it came from (at least 6 characters) so it fits in place
+                if (cp < 0x80)
+                    *out++ = (char) cp;
+                else if (cp < 0x800) {
+                    *out++ = (char) (0xC0 | cp >> 6);
+                    *out++ = (char) (0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    *out++ = (char) (0xE0 | cp >> 12);
+                    *out++ = (char) (0x80 | (cp >> 6 & 0x3F));
+                    *out++ = (char) (0x80 | (cp & 0x3F));
+                } else {
+                    *out++ = (char) (0xF0 | cp >> 18);
+                    *out++ = (char) (0x80 | (cp >> 12 & 0x3F));
+                    *out++ = (char) (0x80 | (cp >> 6 & 0x3F));
+                    *out++ = (char) (0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default:
+                return NULL;
+        }
+    }
+    *out = '\0';
+    return p + 1;
+}
+
+// Skips over a number, true, false or null and returns the character after it, or NULL if there is none at p
+static char *TTJSON_literal(char *p, TTJSONType_t *outType) {
+    if (!strncmp(p, "true", 4) || !strncmp(p, "null", 4)) {
+        *outType = *p == 't' ? TTJSON_BOOL : TTJSON_NULL;
+        return p + 4;
+    } else if (!strncmp(p, "false", 5)) {
+        *outType = TTJSON_BOOL;
+        return p + 5;
+    }
+    
+    char *start = p;
+    if (*p == '-')
+        p++;
+    if (*p < '0' || *p > '9')
+        return NULL;
+    while ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-')
+        p++;
+    
+    // Let strtod have the final say on whether that was really a number
+    char c = *p;
+    *p = '\0';
+    char *end;
+    strtod(start, &end);
+    *p = c;
+    if (end != p)
+        return NULL;
+    *outType = TTJSON_NUMBER;
+    return p;
+}
+
+// Skips over an array of scalars starting at its opening bracket and returns the character after it, or NULL if it is
+// malformed. Strings inside it are left escaped.
+static char *TTJSON_array(char *p) {
+    p = TTJSON_skipSpace(p + 1);
+    if (*p == ']')
+        return p + 1;
+    
+    while (true) {
+        if (*p == '"') {
+            for (p++; *p != '"'; p++) {
+                if (!*p)
+                    return NULL;
+                if (*p == '\\' && !*++p)
+                    return NULL;
+            }
+            p++;
+        } else {
+            TTJSONType_t type;
+            if (!(p = TTJSON_literal(p, &type)))
+                return NULL;
+        }
+        
+        p = TTJSON_skipSpace(p);
+        if (*p == ']')
+            return p + 1;
+        if (*p != ',')
+            return NULL;
+        p = TTJSON_skipSpace(p + 1);
+    }
+}
+
+int TTJSON_ParseObject(char *text, TTJSONField_t *fields, size_t maxFields, size_t *outCount) {
+    char *p = TTJSON_skipSpace(text);
+    if (*p++ != '{')
+        return EINVAL;
+    
+    size_t count = 0;
+    p = TTJSON_skipSpace(p);
+    bool more = *p != '}';
+    if (!more)
+        p++;
+    while (more) {
+        if (*p++ != '"')
+            return EINVAL;
+        char *key = p;
+        if (!(p = TTJSON_string(p)))
+            return EINVAL;
+        p = TTJSON_skipSpace(p);
+        if (*p++ != ':')
+            return EINVAL;
+        p = TTJSON_skipSpace(p);
+        
+        TTJSONField_t field = { .key = key, .value = p };
+        if (*p == '"') {
+            field.type = TTJSON_STRING;
+            field.value = ++p;
+            p = TTJSON_string(p);
+        } else if (*p == '[') {
+            field.type = TTJSON_ARRAY;
+            p = TTJSON_array(p);
+        } else
+            p = TTJSON_literal(p, &field.type);
+        if (!p)
+            return EINVAL;
+        
+        // Values other than strings end right where the next token starts so they can only be terminated once that
+        // token has been read
+        char *end = p;
+        p = TTJSON_skipSpace(p);
+        char next = *p++;
+        if (next != ',' && next != '}')
+            return EINVAL;
+        if (field.type != TTJSON_STRING)
+            *end = '\0';
+        more = next == ',';
+        
+        if (count == maxFields)
+            return E2BIG;
+        fields[count++] = field;
+    }
+    
+    if (*TTJSON_skipSpace(p))
+        return EINVAL;
+    *outCount = count;
+    return 0;
+}
+
+int TTJSON_ParseNumbers(char *array, double *out, size_t max, size_t *outCount) {
+    char *p = TTJSON_skipSpace(array);
+    if (*p++ != '[')
+        return EINVAL;
+    
+    size_t count = 0;
+    p = TTJSON_skipSpace(p);
+    if (*p == ']') {
+        *outCount = 0;
+        return 0;
+    }
+    while (true) {
+        char *end;
+        double v = strtod(p, &end);
+        if (end == p)
+            return EINVAL;
+        if (count == max)
+            return E2BIG;
+        out[count++] = v;
+        
+        p = TTJSON_skipSpace(end);
+        if (*p == ']')
+            break;
+        if (*p++ != ',')
+            return EINVAL;
+        p = TTJSON_skipSpace(p);
+    }
+    
+    *outCount = count;
+    return 0;
+}
+
+static bool TTJSONBuf_reserve(TTJSONBuf_t *buf, size_t extra) {
+    if (buf->failed)
+        return false;
+    if (buf->len + extra < buf->cap)
+        return true;
+    
+    size_t cap = buf->cap ? buf->cap : 256;
+    while (buf->len + extra >= cap)
+        cap *= 2;
+    char *data = realloc(buf->data, cap);
+    if (!data) {
+        buf->failed = true;
+        return false;
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return true;
+}
+
+void TTJSONBuf_Printf(TTJSONBuf_t *buf, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (n < 0 || !TTJSONBuf_reserve(buf, (size_t) n))
+        return;
+    
+    va_start(args, fmt);
+    vsnprintf(buf->data + buf->len, buf->cap - buf->len, fmt, args);
+    va_end(args);
+    buf->len += (size_t) n;
+}
+
+void TTJSONBuf_String(TTJSONBuf_t *buf, const char *str) {
+    // Worst case every character becomes a \u escape
+    if (!TTJSONBuf_reserve(buf, strlen(str) * 6 + 2))
+        return;
+    
+    char *out = buf->data + buf->len;
+    *out++ = '"';
+    for (; *str; str++) {
+        unsigned char ch = (unsigned char) *str;
+        if (ch == '"' || ch == '\\') {
+            *out++ = '\\';
+            *out++ = (char) ch;
+        } else if (ch < 0x20)
+            out += sprintf(out, "\\u%04x", ch);
+        else
+            *out++ = (char) ch;
+    }
+    *out++ = '"';
+    *out = '\0';
+    buf->len = (size_t) (out - buf->data);
+}
+
+void TTJSONBuf_Free(TTJSONBuf_t *buf) {
+    free(buf->data);
+    *buf = (TTJSONBuf_t) { .data = NULL, .len = 0, .cap = 0, .failed = false };
+}
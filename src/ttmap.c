@@ -0,0 +1,153 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttmap.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#include <stdext.h>
+
+static int TTMap_read(char *path, TTMap_t *map) {
+    FILE *file;
+    if (cfopen(path, "rb", &file))
+        return errno;
+    
+    size_t size = 0;
+    if (cfsize(&size, file)) {
+        int err = errno;
+        cfclose(file);
+        return err;
+    }
+    
+    uint8_t *data = size ? malloc(size) : NULL;
+    if (size && !data) {
+        cfclose(file);
+        return ENOMEM;
+    }
+    if (size && cfread(data, sizeof(uint8_t), size, file)) {
+        int err = errno;
+        free(data);
+        cfclose(file);
+        return err;
+    }
+    cfclose(file);
+    
+    map->data = data;
+    map->size = size;
+    map->mapped = false;
+    return 0;
+}
+
+#ifdef _WIN32
+int TTMap_Open(char *path, TTMap_t *map) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return TTMap_read(path, map);
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || !size.QuadPart || (unsigned long long) size.QuadPart > SIZE_MAX) {
+        CloseHandle(file);
+        return TTMap_read(path, map);
+    }
+    
+    // The view keeps the mapping object alive so neither handle is needed past this point
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : NULL;
+    if (mapping)
+        CloseHandle(mapping);
+    CloseHandle(file);
+    if (!view)
+        return TTMap_read(path, map);
+    
+    map->data = view;
+    map->size = (size_t) size.QuadPart;
+    map->mapped = true;
+    return 0;
+}
+
+void TTMap_Close(TTMap_t *map) {
+    if (map->mapped)
+        UnmapViewOfFile(map->data);
+    else
+        free(map->data);
+    map->data = NULL;
+    map->size = 0;
+    map->mapped = false;
+}
+#else
+int TTMap_Open(char *path, TTMap_t *map) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+        return errno;
+    
+    struct stat st;
+    if (fstat(fd, &st)) {
+        int err = errno;
+        close(fd);
+        return err;
+    }
+    if (!S_ISREG(st.st_mode) || !st.st_size || (unsigned long long) st.st_size > SIZE_MAX) {
+        close(fd);
+        return TTMap_read(path, map);
+    }
+    
+    // Private pages are copy on write so parsers that modify their input in place never touch the file. The mapping
+    // stays valid after the descriptor is closed.
+    void *view = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return TTMap_read(path, map);
+#ifdef POSIX_MADV_SEQUENTIAL
+    // Files are parsed front to back once so read ahead aggressively
+    posix_madvise(view, (size_t) st.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+    
+    map->data = view;
+    map->size = (size_t) st.st_size;
+    map->mapped = true;
+    return 0;
+}
+
+void TTMap_Close(TTMap_t *map) {
+    if (map->mapped)
+        munmap(map->data, map->size);
+    else
+        free(map->data);
+    map->data = NULL;
+    map->size = 0;
+    map->mapped = false;
+}
+#endif
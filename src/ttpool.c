@@ -0,0 +1,222 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttpool.h>
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <pthread.h>
+
+#include <stdext.h>
+
+struct TTPoolState;
+
+// Each worker owns a contiguous range of the remaining job indices. The owner takes jobs from the front of its range
+// and idle workers steal the back half of the largest range left, so a worker stuck on a few huge jobs gets its
+// backlog taken over instead of everyone else going idle.
+typedef struct TTPoolWorker {
+    pthread_mutex_t lock;
+    size_t lo;
+    size_t hi;
+    size_t index;
+    struct TTPoolState *state;
+} TTPoolWorker_t;
+
+typedef struct TTPoolState {
+    TTPoolWorker_t *workers;
+    size_t workerCount;
+    TTPoolJob_t job;
+    void *ctx;
+} TTPoolState_t;
+
+size_t TTPool_CPUCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (size_t) si.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t) n : 1;
+#endif
+}
+
+size_t TTPool_ThreadCount(size_t requested, size_t jobCount) {
+    size_t n = requested ? requested : TTPool_CPUCount();
+    if (n > jobCount)
+        n = jobCount;
+    return n ? n : 1;
+}
+
+static bool TTPool_pop(TTPoolWorker_t *w, size_t *job) {
+    pthread_mutex_lock(&w->lock);
+    bool got = w->lo < w->hi;
+    if (got)
+        *job = w->lo++;
+    pthread_mutex_unlock(&w->lock);
+    return got;
+}
+
+static bool TTPool_steal(TTPoolWorker_t *self) {
+    TTPoolState_t *s = self->state;
+    while (catexit_loopSafety) {
+        TTPoolWorker_t *victim = NULL;
+        size_t most = 0;
+        for (size_t i = 1; i < s->workerCount; i++) {
+            TTPoolWorker_t *w = &s->workers[(self->index + i) % s->workerCount];
+            pthread_mutex_lock(&w->lock);
+            size_t left = w->hi - w->lo;
+            pthread_mutex_unlock(&w->lock);
+            if (left > most) {
+                most = left;
+                victim = w;
+            }
+        }
+        if (!victim)
+            return false;
+        
+        // The victim may have drained since it was looked at, in which case look again
+        pthread_mutex_lock(&victim->lock);
+        size_t left = victim->hi - victim->lo;
+        size_t take = (left + 1) / 2;
+        size_t hi = victim->hi;
+        victim->hi -= take;
+        pthread_mutex_unlock(&victim->lock);
+        if (!take)
+            continue;
+        
+        pthread_mutex_lock(&self->lock);
+        self->lo = hi - take;
+        self->hi = hi;
+        pthread_mutex_unlock(&self->lock);
+        return true;
+    }
+    return false;
+}
+
+static void *TTPool_work(void *arg) {
+    TTPoolWorker_t *w = arg;
+    size_t j;
+    while (catexit_loopSafety && (TTPool_pop(w, &j) || (TTPool_steal(w) && TTPool_pop(w, &j))))
+        w->state->job(w->state->ctx, j, w->index);
+    return NULL;
+}
+
+void TTPool_Run(size_t threadCount, size_t jobCount, TTPoolJob_t job, void *ctx) {
+    if (!jobCount || !job)
+        return;
+    
+    size_t n = TTPool_ThreadCount(threadCount, jobCount);
+    TTPoolWorker_t *workers = n > 1 ? malloc(sizeof(TTPoolWorker_t) * n) : NULL;
+    pthread_t *threads = n > 1 ? malloc(sizeof(pthread_t) * n) : NULL;
+    size_t locks = 0;
+    if (workers && threads)
+        while (locks < n && !pthread_mutex_init(&workers[locks].lock, NULL))
+            locks++;
+    if (!workers || !threads || locks < n) {
+        // Not enough resources to go wide so just do everything here
+        for (size_t t = 0; t < locks; t++)
+            pthread_mutex_destroy(&workers[t].lock);
+        free(workers);
+        free(threads);
+        for (size_t j = 0; catexit_loopSafety && j < jobCount; j++)
+            job(ctx, j, 0);
+        return;
+    }
+    
+    TTPoolState_t state = {
+        .workers = workers,
+        .workerCount = n,
+        .job = job,
+        .ctx = ctx
+    };
+    for (size_t t = 0; t < n; t++) {
+        workers[t].lo = jobCount * t / n;
+        workers[t].hi = jobCount * (t + 1) / n;
+        workers[t].index = t;
+        workers[t].state = &state;
+    }
+    
+    // Workers that fail to start keep their ranges which the started ones will steal
+    size_t started = 1;
+    for (size_t t = 1; t < n; t++)
+        if (!pthread_create(&threads[t], NULL, TTPool_work, &workers[t]))
+            threads[started++] = threads[t];
+    
+    TTPool_work(&workers[0]);
+    for (size_t t = 1; t < started; t++)
+        pthread_join(threads[t], NULL);
+    
+    for (size_t t = 0; t < n; t++)
+        pthread_mutex_destroy(&workers[t].lock);
+    free(workers);
+    free(threads);
+}
+
+bool TTBudget_Init(TTBudget_t *budget, size_t limit) {
+    budget->limit = limit;
+    budget->inUse = 0;
+    if (pthread_mutex_init(&budget->lock, NULL))
+        return false;
+    if (pthread_cond_init(&budget->cond, NULL)) {
+        pthread_mutex_destroy(&budget->lock);
+        return false;
+    }
+    return true;
+}
+
+size_t TTBudget_Acquire(TTBudget_t *budget, size_t amount) {
+    if (!budget || !budget->limit)
+        return 0;
+    if (amount > budget->limit)
+        amount = budget->limit;
+    
+    pthread_mutex_lock(&budget->lock);
+    while (budget->inUse + amount > budget->limit)
+        pthread_cond_wait(&budget->cond, &budget->lock);
+    budget->inUse += amount;
+    pthread_mutex_unlock(&budget->lock);
+    return amount;
+}
+
+void TTBudget_Release(TTBudget_t *budget, size_t amount) {
+    if (!budget || !amount)
+        return;
+    
+    pthread_mutex_lock(&budget->lock);
+    budget->inUse -= amount;
+    pthread_cond_broadcast(&budget->cond);
+    pthread_mutex_unlock(&budget->lock);
+}
+
+void TTBudget_Free(TTBudget_t *budget) {
+    pthread_cond_destroy(&budget->cond);
+    pthread_mutex_destroy(&budget->lock);
+}
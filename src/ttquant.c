@@ -0,0 +1,546 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttquant.h>
+#include <ttpool.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
+#include <stdext.h>
+
+// A colour of the image packed as R | G << 8 | B << 16 | A << 24 and how many pixels have it
+typedef struct TTQuantColor {
+    uint32_t rgba;
+    uint32_t weight;
+} TTQuantColor_t;
+
+typedef struct TTQuantCut {
+    TTQuantColor_t *colors;
+    uint8_t (*out)[4];
+    size_t outCount;
+} TTQuantCut_t;
+
+// One tap of an error diffusion kernel
+typedef struct TTQuantTap {
+    int8_t dx;
+    int8_t dy;
+    uint8_t weight;
+} TTQuantTap_t;
+
+typedef struct TTQuantKernel {
+    TTQuantTap_t *taps;
+    size_t tapCount;
+    float divisor;
+} TTQuantKernel_t;
+
+#define TTQUANT_KERNEL(div, ...) { \
+        .taps = (TTQuantTap_t[]) { __VA_ARGS__ }, \
+        .tapCount = sizeof((TTQuantTap_t[]) { __VA_ARGS__ }) / sizeof(TTQuantTap_t), \
+        .divisor = div \
+    }
+
+static TTQuantKernel_t ttquantKernels[GX_DT_MAX + 1] = {
+    [GX_DT_THRESHOLD] = { .taps = NULL, .tapCount = 0, .divisor = 1.0f },
+    [GX_DT_FLOYD_STEINBERG] = TTQUANT_KERNEL(16.0f,
+        { 1, 0, 7 }, { -1, 1, 3 }, { 0, 1, 5 }, { 1, 1, 1 }),
+    [GX_DT_ATKINSON] = TTQUANT_KERNEL(8.0f,
+        { 1, 0, 1 }, { 2, 0, 1 }, { -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 }, { 0, 2, 1 }),
+    [GX_DT_JARVIS_JUDICE_NINKE] = TTQUANT_KERNEL(48.0f,
+        { 1, 0, 7 }, { 2, 0, 5 },
+        { -2, 1, 3 }, { -1, 1, 5 }, { 0, 1, 7 }, { 1, 1, 5 }, { 2, 1, 3 },
+        { -2, 2, 1 }, { -1, 2, 3 }, { 0, 2, 5 }, { 1, 2, 3 }, { 2, 2, 1 }),
+    [GX_DT_STUCKI] = TTQUANT_KERNEL(42.0f,
+        { 1, 0, 8 }, { 2, 0, 4 },
+        { -2, 1, 2 }, { -1, 1, 4 }, { 0, 1, 8 }, { 1, 1, 4 }, { 2, 1, 2 },
+        { -2, 2, 1 }, { -1, 2, 2 }, { 0, 2, 4 }, { 1, 2, 2 }, { 2, 2, 1 }),
+    [GX_DT_BURKES] = TTQUANT_KERNEL(32.0f,
+        { 1, 0, 8 }, { 2, 0, 4 },
+        { -2, 1, 2 }, { -1, 1, 4 }, { 0, 1, 8 }, { 1, 1, 4 }, { 2, 1, 2 }),
+    [GX_DT_TWO_ROW_SIERRA] = TTQUANT_KERNEL(16.0f,
+        { 1, 0, 4 }, { 2, 0, 3 },
+        { -2, 1, 1 }, { -1, 1, 2 }, { 0, 1, 3 }, { 1, 1, 2 }, { 2, 1, 1 }),
+    [GX_DT_SIERRA] = TTQUANT_KERNEL(32.0f,
+        { 1, 0, 5 }, { 2, 0, 3 },
+        { -2, 1, 2 }, { -1, 1, 4 }, { 0, 1, 5 }, { 1, 1, 4 }, { 2, 1, 2 },
+        { -1, 2, 2 }, { 0, 2, 3 }, { 1, 2, 2 }),
+    [GX_DT_SIERRA_LITE] = TTQUANT_KERNEL(4.0f,
+        { 1, 0, 2 }, { -1, 1, 1 }, { 0, 1, 1 })
+};
+
+// Kernels reach at most 2 pixels to either side and 2 rows down
+#define TTQUANT_REACH 2
+
+size_t TTQuant_PaletteSize(TXTRFormat_t fmt) {
+    switch (fmt) {
+        case TXTR_TTF_CI4:
+            return 16;
+        case TXTR_TTF_CI8:
+            return 256;
+        case TXTR_TTF_CI14X2:
+            return 16384;
+        default:
+            return 0;
+    }
+}
+
+FORCE_INLINE uint8_t TTQuant_channel(uint32_t rgba, uint8_t axis) {
+    return (uint8_t) (rgba >> (axis * 8));
+}
+
+// Rounds v to bits bits and expands it back to 8 the way GX does
+FORCE_INLINE uint8_t TTQuant_round(uint8_t v, uint8_t bits) {
+    uint32_t max = (1u << bits) - 1;
+    uint32_t q = (v * max + 127) / 255;
+    uint32_t e = q << (8 - bits);
+    for (uint8_t shift = bits; shift < 8; shift += bits)
+        e |= q << (8 - bits) >> shift;
+    return (uint8_t) e;
+}
+
+// The colour palFmt would store for c
+static void TTQuant_snap(TXTRPaletteFormat_t palFmt, uint8_t c[4]) {
+    switch (palFmt) {
+        case TXTR_TPF_IA8: {
+            uint8_t i = (uint8_t) ((c[0] + c[1] + c[2] + 1) / 3);
+            c[0] = c[1] = c[2] = i;
+            break;
+        }
+        case TXTR_TPF_R5G6B5:
+            c[0] = TTQuant_round(c[0], 5);
+            c[1] = TTQuant_round(c[1], 6);
+            c[2] = TTQuant_round(c[2], 5);
+            c[3] = 0xFF;
+            break;
+        case TXTR_TPF_RGB5A3: {
+            // Only RGB555 is opaque, anything with alpha is ARGB3444
+            uint8_t a = TTQuant_round(c[3], 3);
+            uint8_t bits = a == 0xFF ? 5 : 4;
+            c[0] = TTQuant_round(c[0], bits);
+            c[1] = TTQuant_round(c[1], bits);
+            c[2] = TTQuant_round(c[2], bits);
+            c[3] = a;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Palette building tasks
+
+static int TTQuant_cmpRGBA(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+#define TTQUANT_CMPAXIS(axis) \
+    static int TTQuant_cmpAxis ## axis(const void *a, const void *b) { \
+        uint8_t x = TTQuant_channel(((const TTQuantColor_t *) a)->rgba, axis); \
+        uint8_t y = TTQuant_channel(((const TTQuantColor_t *) b)->rgba, axis); \
+        return (x > y) - (x < y); \
+    }
+TTQUANT_CMPAXIS(0)
+TTQUANT_CMPAXIS(1)
+TTQUANT_CMPAXIS(2)
+TTQUANT_CMPAXIS(3)
+#undef TTQUANT_CMPAXIS
+
+static int (*ttquantCmpAxis[4])(const void *, const void *) = {
+    TTQuant_cmpAxis0,
+    TTQuant_cmpAxis1,
+    TTQuant_cmpAxis2,
+    TTQuant_cmpAxis3
+};
+
+// The channel with the widest range over colors
+static uint8_t TTQuant_widestAxis(TTQuantColor_t *colors, size_t count, uint8_t *outRange) {
+    uint8_t lo[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    uint8_t hi[4] = { 0, 0, 0, 0 };
+    for (size_t i = 0; i < count; i++) {
+        for (uint8_t a = 0; a < 4; a++) {
+            uint8_t v = TTQuant_channel(colors[i].rgba, a);
+            lo[a] = v < lo[a] ? v : lo[a];
+            hi[a] = v > hi[a] ? v : hi[a];
+        }
+    }
+    uint8_t axis = 0;
+    for (uint8_t a = 1; a < 4; a++)
+        if (hi[a] - lo[a] > hi[axis] - lo[axis])
+            axis = a;
+    *outRange = (uint8_t) (hi[axis] - lo[axis]);
+    return axis;
+}
+
+// Splits colors into k boxes at the weighted median of their widest channel, handing a box's share of k that it has
+// too few colours for to its sibling, and emits every box's weighted mean
+static void TTQuant_cut(TTQuantCut_t *cut, size_t lo, size_t hi, size_t k) {
+    uint8_t range = 0;
+    uint8_t axis = TTQuant_widestAxis(&cut->colors[lo], hi - lo, &range);
+    if (k <= 1 || hi - lo <= 1 || !range) {
+        uint64_t sum[4] = { 0, 0, 0, 0 };
+        uint64_t total = 0;
+        for (size_t i = lo; i < hi; i++) {
+            for (uint8_t a = 0; a < 4; a++)
+                sum[a] += (uint64_t) TTQuant_channel(cut->colors[i].rgba, a) * cut->colors[i].weight;
+            total += cut->colors[i].weight;
+        }
+        uint8_t *out = cut->out[cut->outCount++];
+        for (uint8_t a = 0; a < 4; a++)
+            out[a] = (uint8_t) ((sum[a] + total / 2) / total);
+        return;
+    }
+    
+    qsort(&cut->colors[lo], hi - lo, sizeof(TTQuantColor_t), ttquantCmpAxis[axis]);
+    uint64_t total = 0;
+    for (size_t i = lo; i < hi; i++)
+        total += cut->colors[i].weight;
+    size_t mid = lo + 1;
+    for (uint64_t acc = cut->colors[lo].weight; mid < hi - 1 && acc * 2 < total; mid++)
+        acc += cut->colors[mid].weight;
+    
+    size_t kl = k / 2;
+    size_t kr = k - kl;
+    if (kl > mid - lo) {
+        kr += kl - (mid - lo);
+        kl = mid - lo;
+    }
+    if (kr > hi - mid) {
+        kl += kr - (hi - mid);
+        kr = hi - mid;
+        if (kl > mid - lo)
+            kl = mid - lo;
+    }
+    TTQuant_cut(cut, lo, mid, kl);
+    TTQuant_cut(cut, mid, hi, kr);
+}
+
+// Every distinct colour of pixels with how often it occurs
+static int TTQuant_histogram(const uint8_t *pixels, size_t pixelCount, TTQuantColor_t **outColors,
+size_t *outCount) {
+    uint32_t *sorted = malloc(sizeof(uint32_t) * pixelCount);
+    if (!sorted)
+        return ENOMEM;
+    memcpy(sorted, pixels, sizeof(uint32_t) * pixelCount);
+    qsort(sorted, pixelCount, sizeof(uint32_t), TTQuant_cmpRGBA);
+    
+    size_t count = 0;
+    for (size_t i = 0; i < pixelCount; i++)
+        count += !i || sorted[i] != sorted[i - 1];
+    TTQuantColor_t *colors = malloc(sizeof(TTQuantColor_t) * count);
+    if (!colors) {
+        free(sorted);
+        return ENOMEM;
+    }
+    size_t c = 0;
+    for (size_t i = 0; i < pixelCount; i++) {
+        if (!i || sorted[i] != sorted[i - 1])
+            colors[c++] = (TTQuantColor_t) { .rgba = sorted[i], .weight = 0 };
+        colors[c - 1].weight++;
+    }
+    free(sorted);
+    
+    *outColors = colors;
+    *outCount = count;
+    return 0;
+}
+
+// Tree building tasks
+
+static void TTQuant_buildNode(TTQuant_t *q, size_t first, size_t count) {
+    TTQuantNode_t *node = &q->nodes[q->nodeCount++];
+    *node = (TTQuantNode_t) { .first = (uint16_t) first, .count = (uint16_t) count, .isLeaf = count <= TTQUANT_LEAFSZ };
+    if (node->isLeaf)
+        return;
+    
+    uint8_t lo[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    uint8_t hi[4] = { 0, 0, 0, 0 };
+    for (size_t i = first; i < first + count; i++) {
+        for (uint8_t a = 0; a < 4; a++) {
+            lo[a] = q->treeColors[i][a] < lo[a] ? q->treeColors[i][a] : lo[a];
+            hi[a] = q->treeColors[i][a] > hi[a] ? q->treeColors[i][a] : hi[a];
+        }
+    }
+    uint8_t axis = 0;
+    for (uint8_t a = 1; a < 4; a++)
+        if (hi[a] - lo[a] > hi[axis] - lo[axis])
+            axis = a;
+    
+    // Insertion sort on the axis (trees are small and this keeps colours and indices together)
+    for (size_t i = first + 1; i < first + count; i++) {
+        uint8_t c[4];
+        memcpy(c, q->treeColors[i], 4);
+        uint16_t idx = q->treeIndices[i];
+        size_t j = i;
+        for (; j > first && q->treeColors[j - 1][axis] > c[axis]; j--) {
+            memcpy(q->treeColors[j], q->treeColors[j - 1], 4);
+            q->treeIndices[j] = q->treeIndices[j - 1];
+        }
+        memcpy(q->treeColors[j], c, 4);
+        q->treeIndices[j] = idx;
+    }
+    
+    size_t half = count / 2;
+    node->axis = axis;
+    node->value = q->treeColors[first + half][axis];
+    size_t self = node - q->nodes;
+    TTQuant_buildNode(q, first, half);
+    q->nodes[self].right = (uint32_t) q->nodeCount;
+    TTQuant_buildNode(q, first + half, count - half);
+}
+
+int TTQuant_Build(TTQuant_t *q, const uint8_t *pixels, size_t pixelCount, size_t maxColors,
+TXTRPaletteFormat_t palFmt) {
+    *q = (TTQuant_t) { .colors = NULL };
+    if (!pixelCount || !maxColors || maxColors > 65536)
+        return EINVAL;
+    
+    TTQuantColor_t *colors = NULL;
+    size_t colorCount = 0;
+    int qhe = TTQuant_histogram(pixels, pixelCount, &colors, &colorCount);
+    if (qhe)
+        return qhe;
+    
+    size_t count = colorCount < maxColors ? colorCount : maxColors;
+    TTQuantCut_t cut = { .colors = colors, .out = malloc(sizeof(*cut.out) * count), .outCount = 0 };
+    // A node per leaf and one per split, of which there are fewer than leaves
+    size_t maxNodes = 2 * ((count + TTQUANT_LEAFSZ - 1) / TTQUANT_LEAFSZ) * 2;
+    q->treeColors = malloc(sizeof(*q->treeColors) * count);
+    q->treeIndices = malloc(sizeof(uint16_t) * count);
+    q->nodes = malloc(sizeof(TTQuantNode_t) * maxNodes);
+    if (!cut.out || !q->treeColors || !q->treeIndices || !q->nodes) {
+        free(colors);
+        free(cut.out);
+        TTQuant_Free(q);
+        return ENOMEM;
+    }
+    
+    if (colorCount <= maxColors) {
+        for (size_t i = 0; i < colorCount; i++)
+            memcpy(cut.out[i], &colors[i].rgba, 4);
+        cut.outCount = colorCount;
+    } else
+        TTQuant_cut(&cut, 0, colorCount, count);
+    free(colors);
+    
+    q->colors = cut.out;
+    q->count = cut.outCount;
+    for (size_t i = 0; i < q->count; i++) {
+        TTQuant_snap(palFmt, q->colors[i]);
+        memcpy(q->treeColors[i], q->colors[i], 4);
+        q->treeIndices[i] = (uint16_t) i;
+    }
+    TTQuant_buildNode(q, 0, q->count);
+    
+    return 0;
+}
+
+void TTQuant_Free(TTQuant_t *q) {
+    free(q->colors);
+    free(q->treeColors);
+    free(q->treeIndices);
+    free(q->nodes);
+    *q = (TTQuant_t) { .colors = NULL };
+}
+
+// Lookup tasks
+
+FORCE_INLINE uint32_t TTQuant_dist(const uint8_t a[4], const uint8_t b[4]) {
+    int32_t d0 = a[0] - b[0], d1 = a[1] - b[1], d2 = a[2] - b[2], d3 = a[3] - b[3];
+    return (uint32_t) (d0 * d0 + d1 * d1 + d2 * d2 + d3 * d3);
+}
+
+static void TTQuant_search(TTQuant_t *q, size_t n, const uint8_t px[4], uint32_t *best, size_t *bestAt) {
+    TTQuantNode_t *node = &q->nodes[n];
+    if (node->isLeaf) {
+        for (size_t i = node->first; i < (size_t) node->first + node->count; i++) {
+            uint32_t d = TTQuant_dist(px, q->treeColors[i]);
+            if (d < *best) {
+                *best = d;
+                *bestAt = i;
+            }
+        }
+        return;
+    }
+    
+    // The side px is on first, then the other only if the splitting plane is closer than the best so far
+    int32_t diff = (int32_t) px[node->axis] - node->value;
+    size_t near = diff < 0 ? n + 1 : node->right;
+    size_t far = diff < 0 ? node->right : n + 1;
+    TTQuant_search(q, near, px, best, bestAt);
+    if ((uint32_t) (diff * diff) < *best)
+        TTQuant_search(q, far, px, best, bestAt);
+}
+
+uint16_t TTQuant_Nearest(TTQuant_t *q, const uint8_t px[4]) {
+    uint32_t best = UINT32_MAX;
+    size_t bestAt = 0;
+    TTQuant_search(q, 0, px, &best, &bestAt);
+    return q->treeIndices[bestAt];
+}
+
+// Dither tasks
+
+// Lookups remembered by exact colour, which flat areas and images with few colours hit nearly every time
+#define TTQUANT_CACHESZ 4096
+
+typedef struct TTQuantCacheEntry {
+    uint32_t rgba;
+    uint32_t index;
+} TTQuantCacheEntry_t;
+
+FORCE_INLINE uint16_t TTQuant_cachedNearest(TTQuant_t *q, TTQuantCacheEntry_t *cache, const uint8_t px[4]) {
+    uint32_t rgba;
+    memcpy(&rgba, px, 4);
+    TTQuantCacheEntry_t *e = &cache[(rgba * 0x9E3779B1u) >> (32 - 12)];
+    if (e->index != UINT32_MAX && e->rgba == rgba)
+        return (uint16_t) e->index;
+    
+    uint16_t index = TTQuant_Nearest(q, px);
+    *e = (TTQuantCacheEntry_t) { .rgba = rgba, .index = index };
+    return index;
+}
+
+FORCE_INLINE uint8_t TTQuant_clamp(float v) {
+    return v <= 0.0f ? 0 : v >= 255.0f ? 255 : (uint8_t) (v + 0.5f);
+}
+
+// Rows are dithered as a wavefront: each worker takes the next row and follows the row above it TTQUANT_LAG pixels
+// behind, far enough that every pixel a tap could reach from above is already done. Instead of pushing error forward
+// each pixel keeps what it got wrong and pulls its own error from the pixels that reach it, in the order the serial
+// algorithm would have added it, so the floats come out bit for bit the same whatever the thread count.
+#define TTQUANT_LAG (TTQUANT_REACH + 1)
+
+typedef struct TTQuantDither {
+    TTQuant_t *q;
+    TTQuantKernel_t *kernel;
+    uint8_t *pixels;
+    int16_t (*diffs)[4];
+    size_t *done;
+    size_t nextRow;
+    uint16_t width;
+    uint16_t height;
+} TTQuantDither_t;
+
+// Waits until pixel x of row y may be dithered and returns how many pixels of the row may be by now, or 0 if the run
+// was stopped
+static size_t TTQuant_waitAbove(TTQuantDither_t *d, size_t y, size_t x) {
+    while (catexit_loopSafety) {
+        size_t above = __atomic_load_n(&d->done[y - 1], __ATOMIC_ACQUIRE);
+        if (above == d->width)
+            return above;
+        if (above >= x + TTQUANT_LAG)
+            return above - TTQUANT_LAG + 1;
+        sched_yield();
+    }
+    return 0;
+}
+
+static void TTQuant_ditherRow(TTQuantDither_t *d, TTQuantCacheEntry_t *cache, size_t y) {
+    TTQuantKernel_t *kernel = d->kernel;
+    size_t ready = d->done && y ? 0 : d->width;
+    for (size_t x = 0; x < d->width; x++) {
+        if (x >= ready && !(ready = TTQuant_waitAbove(d, y, x)))
+            return;
+        
+        // Taps are listed by row then column so walking them backwards visits the pixels reaching this one in the
+        // order they were dithered
+        float err[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (size_t t = kernel->tapCount; t-- > 0;) {
+            TTQuantTap_t *tap = &kernel->taps[t];
+            ptrdiff_t sx = (ptrdiff_t) x - tap->dx;
+            if ((size_t) tap->dy > y || sx < 0 || sx >= d->width)
+                continue;
+            int16_t *diff = d->diffs[(y - tap->dy) * d->width + (size_t) sx];
+            float w = tap->weight / kernel->divisor;
+            for (size_t c = 0; c < 4; c++)
+                err[c] += (float) diff[c] * w;
+        }
+        
+        uint8_t *px = &d->pixels[(y * d->width + x) * 4];
+        uint8_t want[4];
+        for (size_t c = 0; c < 4; c++)
+            want[c] = TTQuant_clamp(px[c] + err[c]);
+        uint8_t *got = d->q->colors[TTQuant_cachedNearest(d->q, cache, want)];
+        for (size_t c = 0; c < 4; c++)
+            d->diffs[y * d->width + x][c] = (int16_t) (want[c] - got[c]);
+        memcpy(px, got, 4);
+        
+        if (d->done)
+            __atomic_store_n(&d->done[y], x + 1, __ATOMIC_RELEASE);
+    }
+}
+
+// One job per worker, each taking rows in order until there are none left. Taking them in order is what keeps this
+// from deadlocking: the row a worker waits on was always taken earlier by a worker that is still going.
+static void TTQuant_ditherJob(void *ctx, size_t job, size_t worker) {
+    FAKEREF(job);
+    FAKEREF(worker);
+    TTQuantDither_t *d = ctx;
+    TTQuantCacheEntry_t cache[TTQUANT_CACHESZ];
+    for (size_t i = 0; i < TTQUANT_CACHESZ; i++)
+        cache[i] = (TTQuantCacheEntry_t) { .rgba = 0, .index = UINT32_MAX };
+    
+    size_t y;
+    while (catexit_loopSafety && (y = __atomic_fetch_add(&d->nextRow, 1, __ATOMIC_RELAXED)) < d->height)
+        TTQuant_ditherRow(d, cache, y);
+}
+
+int TTQuant_Dither(TTQuant_t *q, GXDitherType_t ditherType, uint8_t *pixels, uint16_t width, uint16_t height,
+size_t threads) {
+    if (ditherType < GX_DT_MIN || ditherType > GX_DT_MAX)
+        return EINVAL;
+    
+    TTQuantDither_t d = {
+        .q = q,
+        .kernel = &ttquantKernels[ditherType],
+        .pixels = pixels,
+        .diffs = NULL,
+        .done = NULL,
+        .nextRow = 0,
+        .width = width,
+        .height = height
+    };
+    if (!width || !height)
+        return 0;
+    
+    // Threshold has nothing to diffuse so its rows never wait on each other
+    threads = TTPool_ThreadCount(threads, height);
+    d.diffs = malloc(sizeof(int16_t [4]) * width * height);
+    d.done = threads > 1 && d.kernel->tapCount ? calloc(height, sizeof(size_t)) : NULL;
+    if (!d.diffs || (threads > 1 && d.kernel->tapCount && !d.done)) {
+        free(d.diffs);
+        free(d.done);
+        return ENOMEM;
+    }
+    
+    TTPool_Run(threads, threads, TTQuant_ditherJob, &d);
+    free(d.diffs);
+    free(d.done);
+    
+    return catexit_loopSafety ? 0 : EINTR;
+}
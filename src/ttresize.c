@@ -0,0 +1,132 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ttresize.h>
+#include <ttisa.h>
+
+
+TTRESIZE_PROTO(TTResize) {
+    switch (TTISA_Active()) {
+#ifdef TXTRTOOL_ISA_DISPATCH
+        case TTISA_AVX2:
+            return TTResize_avx2(input, inputW, inputH, inputStride, output, outputW, outputH, outputStride, layout,
+                type, edge, filter);
+        case TTISA_AVX:
+            return TTResize_avx(input, inputW, inputH, inputStride, output, outputW, outputH, outputStride, layout,
+                type, edge, filter);
+        case TTISA_SSE2:
+            return TTResize_sse2(input, inputW, inputH, inputStride, output, outputW, outputH, outputStride, layout,
+                type, edge, filter);
+#endif
+        default:
+            return stbir_resize(input, inputW, inputH, inputStride, output, outputW, outputH, outputStride, layout,
+                type, edge, filter);
+    }
+}
+
+TTRESIZE_DEFINE_OPS(TTResizeOps_baseline);
+
+static const TTResizeOps_t *TTResize_ops(TTISA_t isa) {
+    switch (isa) {
+#ifdef TXTRTOOL_ISA_DISPATCH
+        case TTISA_AVX2:
+            return &TTResizeOps_avx2;
+        case TTISA_AVX:
+            return &TTResizeOps_avx;
+        case TTISA_SSE2:
+            return &TTResizeOps_sse2;
+#endif
+        default:
+            return &TTResizeOps_baseline;
+    }
+}
+
+void TTResizeCache_Init(TTResizeCache_t *cache) {
+    cache->count = 0;
+    cache->clock = 0;
+    cache->hits = 0;
+}
+
+void *TTResizeCache_Resize(TTResizeCache_t *cache, const void *input, int inputW, int inputH, int inputStride,
+void *output, int outputW, int outputH, int outputStride, stbir_pixel_layout layout, stbir_datatype type,
+stbir_edge edge, stbir_filter filter) {
+    if (!cache)
+        return TTResize(input, inputW, inputH, inputStride, output, outputW, outputH, outputStride, layout, type, edge,
+            filter);
+    
+    const TTResizeOps_t *ops = TTResize_ops(TTISA_Active());
+    TTResizeEntry_t *entry = NULL;
+    for (size_t e = 0; e < cache->count && !entry; e++) {
+        TTResizeEntry_t *c = &cache->entries[e];
+        if (c->ops == ops && c->inputW == inputW && c->inputH == inputH && c->inputStride == inputStride &&
+            c->outputW == outputW && c->outputH == outputH && c->outputStride == outputStride && c->layout == layout &&
+            c->type == type && c->edge == edge && c->filter == filter)
+            entry = c;
+    }
+    
+    if (entry)
+        cache->hits++;
+    else {
+        // A free slot, or else the one used longest ago
+        if (cache->count < TTRESIZE_CACHESZ)
+            entry = &cache->entries[cache->count++];
+        else {
+            entry = &cache->entries[0];
+            for (size_t e = 1; e < cache->count; e++)
+                if (cache->entries[e].lastUse < entry->lastUse)
+                    entry = &cache->entries[e];
+            entry->ops->release(&entry->resize);
+        }
+        
+        *entry = (TTResizeEntry_t) {
+            .ops = ops,
+            .inputW = inputW,
+            .inputH = inputH,
+            .inputStride = inputStride,
+            .outputW = outputW,
+            .outputH = outputH,
+            .outputStride = outputStride,
+            .layout = layout,
+            .type = type,
+            .edge = edge,
+            .filter = filter
+        };
+        if (!ops->build(&entry->resize, inputW, inputH, inputStride, outputW, outputH, outputStride, layout, type, edge,
+            filter)) {
+            // Drop the slot by moving the last entry into it
+            ops->release(&entry->resize);
+            *entry = cache->entries[--cache->count];
+            return NULL;
+        }
+    }
+    
+    entry->lastUse = ++cache->clock;
+    return entry->ops->run(&entry->resize, input, inputStride, output, outputStride) ? output : NULL;
+}
+
+void TTResizeCache_Free(TTResizeCache_t *cache) {
+    for (size_t e = 0; e < cache->count; e++)
+        cache->entries[e].ops->release(&cache->entries[e].resize);
+    cache->count = 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Built once per instruction set (see CMakeLists.txt) with TXTRTOOL_ISA set to sse2, avx or avx2 and the matching -m
+// flag. Each build gets its own private copy of stb_image_resize2 so they can all live in one program.
+
+#ifndef TXTRTOOL_ISA
+#error TXTRTOOL_ISA must be defined
+#endif
+
+#define TTRESIZE_sse2 1
+#define TTRESIZE_avx 2
+#define TTRESIZE_avx2 3
+#define TTRESIZE_CAT(a, b) a ## b
+#define TTRESIZE_XCAT(a, b) TTRESIZE_CAT(a, b)
+#define TTRESIZE_LEVEL TTRESIZE_XCAT(TTRESIZE_, TXTRTOOL_ISA)
+
+#if TTRESIZE_LEVEL == TTRESIZE_avx2
+#define STBIR_AVX2
+#elif TTRESIZE_LEVEL == TTRESIZE_avx
+#define STBIR_AVX
+#elif TTRESIZE_LEVEL == TTRESIZE_sse2
+#define STBIR_SSE2
+#else
+#error Unknown TXTRTOOL_ISA
+#endif
+
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#define STB_IMAGE_RESIZE_STATIC
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#include <stb_image_resize2.h>
+#pragma GCC diagnostic pop
+
+#include <ttresize.h>
+
+TTRESIZE_PROTO(TTRESIZE_XCAT(TTResize_, TXTRTOOL_ISA)) {
+    return stbir_resize(input, inputW, inputH, inputStride, output, outputW, outputH, outputStride, layout, type, edge,
+        filter);
+}
+
+TTRESIZE_DEFINE_OPS(TTRESIZE_XCAT(TTResizeOps_, TXTRTOOL_ISA));
@@ -0,0 +1,500 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <ttserve.h>
+#include <ttpool.h>
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+#endif
+#include <pthread.h>
+
+#include <stdext.h>
+
+// Longest request line taken before the connection sending it is dropped
+#define TTSERVE_MAXLINE (1u << 20)
+// Bytes read from a connection at once
+#define TTSERVE_READSZ 65536
+// Requests queued per worker before the dispatcher stops reading, so a client sending faster than the workers keep up
+// waits instead of growing the queue without bound
+#define TTSERVE_QUEUEPERWORKER 4
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// A connection, or stdin and stdout. It is kept alive by the dispatcher while it reads from it and by every request of
+// it still queued or running so responses always have somewhere to go.
+typedef struct TTServeClient {
+    int inFd;
+    int outFd;
+    bool socket;
+    bool broken;
+    size_t refs;
+    pthread_mutex_t writeLock;
+    char *buf;
+    size_t len;
+    size_t cap;
+} TTServeClient_t;
+
+typedef struct TTServeRequest {
+    struct TTServeRequest *next;
+    TTServeClient_t *client;
+    char line[];
+} TTServeRequest_t;
+
+typedef struct TTServe {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t space;
+    TTServeRequest_t *head;
+    TTServeRequest_t *tail;
+    size_t queued;
+    size_t maxQueued;
+    bool stopping;
+    TTServeHandler_t handler;
+    void *ctx;
+} TTServe_t;
+
+typedef struct TTServeWorker {
+    TTServe_t *server;
+    size_t index;
+    pthread_t thread;
+} TTServeWorker_t;
+
+static TTServeClient_t *TTServe_newClient(int inFd, int outFd, bool socket) {
+    TTServeClient_t *c = malloc(sizeof(TTServeClient_t));
+    if (!c)
+        return NULL;
+    *c = (TTServeClient_t) {
+        .inFd = inFd,
+        .outFd = outFd,
+        .socket = socket,
+        .broken = false,
+        .refs = 1,
+        .buf = NULL,
+        .len = 0,
+        .cap = 0
+    };
+    if (pthread_mutex_init(&c->writeLock, NULL)) {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+static void TTServe_release(TTServe_t *s, TTServeClient_t *c) {
+    pthread_mutex_lock(&s->lock);
+    bool last = !--c->refs;
+    pthread_mutex_unlock(&s->lock);
+    if (!last)
+        return;
+    
+#ifndef _WIN32
+    if (c->socket)
+        close(c->inFd);
+#endif
+    pthread_mutex_destroy(&c->writeLock);
+    free(c->buf);
+    free(c);
+}
+
+static void TTServe_write(TTServeClient_t *c, const char *data, size_t size) {
+    pthread_mutex_lock(&c->writeLock);
+    while (size && !__atomic_load_n(&c->broken, __ATOMIC_RELAXED)) {
+#ifdef _WIN32
+        int n = _write(c->outFd, data, size > INT32_MAX ? INT32_MAX : (unsigned int) size);
+#else
+        ssize_t n = c->socket ? send(c->outFd, data, size, MSG_NOSIGNAL) : write(c->outFd, data, size);
+#endif
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            // The other end is gone, which only its own requests have to care about
+            __atomic_store_n(&c->broken, true, __ATOMIC_RELAXED);
+            break;
+        }
+        data += n;
+        size -= (size_t) n;
+    }
+    pthread_mutex_unlock(&c->writeLock);
+}
+
+static int TTServe_push(TTServe_t *s, TTServeClient_t *c, char *line, size_t len) {
+    TTServeRequest_t *req = malloc(sizeof(TTServeRequest_t) + len + 1);
+    if (!req)
+        return ENOMEM;
+    req->next = NULL;
+    req->client = c;
+    memcpy(req->line, line, len);
+    req->line[len] = '\0';
+    
+    pthread_mutex_lock(&s->lock);
+    while (s->queued >= s->maxQueued)
+        pthread_cond_wait(&s->space, &s->lock);
+    c->refs++;
+    if (s->tail)
+        s->tail->next = req;
+    else
+        s->head = req;
+    s->tail = req;
+    s->queued++;
+    pthread_cond_signal(&s->ready);
+    pthread_mutex_unlock(&s->lock);
+    
+    return 0;
+}
+
+// Queues every complete line in the client's buffer and keeps the partial one left. With final the partial line is a
+// request too (the last line of a stream need not end in a newline).
+static int TTServe_feed(TTServe_t *s, TTServeClient_t *c, bool final) {
+    size_t start = 0;
+    for (size_t i = 0; i <= c->len; i++) {
+        if (i == c->len && !final)
+            break;
+        if (i < c->len && c->buf[i] != '\n')
+            continue;
+        
+        size_t end = i;
+        if (end > start && c->buf[end - 1] == '\r')
+            end--;
+        if (end > start) {
+            int pe = TTServe_push(s, c, &c->buf[start], end - start);
+            if (pe)
+                return pe;
+        }
+        start = i + 1;
+    }
+    
+    if (start > c->len)
+        start = c->len;
+    memmove(c->buf, &c->buf[start], c->len - start);
+    c->len -= start;
+    return c->len > TTSERVE_MAXLINE ? E2BIG : 0;
+}
+
+// Reads what the client has to say. Returns 0 if it may say more, -1 once it has ended or an errno value on failure.
+static int TTServe_read(TTServe_t *s, TTServeClient_t *c) {
+    if (c->cap - c->len < TTSERVE_READSZ) {
+        size_t cap = c->len + TTSERVE_READSZ;
+        char *buf = realloc(c->buf, cap);
+        if (!buf)
+            return ENOMEM;
+        c->buf = buf;
+        c->cap = cap;
+    }
+    
+#ifdef _WIN32
+    int n = _read(c->inFd, &c->buf[c->len], TTSERVE_READSZ);
+#else
+    ssize_t n = read(c->inFd, &c->buf[c->len], TTSERVE_READSZ);
+#endif
+    if (n < 0 && (errno == EINTR || errno == EAGAIN))
+        return 0;
+    if (n <= 0) {
+        int fe = TTServe_feed(s, c, true);
+        return fe ? fe : -1;
+    }
+    c->len += (size_t) n;
+    return TTServe_feed(s, c, false);
+}
+
+static void *TTServe_work(void *arg) {
+    TTServeWorker_t *w = arg;
+    TTServe_t *s = w->server;
+    TTJSONBuf_t reply = { .data = NULL, .len = 0, .cap = 0, .failed = false };
+    
+    pthread_mutex_lock(&s->lock);
+    while (true) {
+        while (!s->head && !s->stopping)
+            pthread_cond_wait(&s->ready, &s->lock);
+        TTServeRequest_t *req = s->head;
+        if (!req)
+            break;
+        s->head = req->next;
+        if (!s->head)
+            s->tail = NULL;
+        s->queued--;
+        pthread_cond_signal(&s->space);
+        pthread_mutex_unlock(&s->lock);
+        
+        // Once interrupted whatever is still queued is only drained
+        if (catexit_loopSafety && !__atomic_load_n(&req->client->broken, __ATOMIC_RELAXED)) {
+            reply.len = 0;
+            reply.failed = false;
+            s->handler(s->ctx, req->line, &reply, w->index);
+            if (reply.len) {
+                TTJSONBuf_Printf(&reply, "\n");
+                if (!reply.failed)
+                    TTServe_write(req->client, reply.data, reply.len);
+            }
+        }
+        TTServe_release(s, req->client);
+        free(req);
+        
+        pthread_mutex_lock(&s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+    TTJSONBuf_Free(&reply);
+    
+    return NULL;
+}
+
+#ifdef _WIN32
+static int TTServe_dispatch(TTServe_t *s, TTServeClient_t *stdio, int listenFd) {
+    FAKEREF(listenFd);
+    _setmode(stdio->outFd, _O_BINARY);
+    int err = 0;
+    while (!err && catexit_loopSafety)
+        err = TTServe_read(s, stdio);
+    return err < 0 ? 0 : err;
+}
+#else
+// Waits on the listening socket and every connection (or just stdin) and turns what they send into requests. Returns
+// once stdin ends, catexit_loopSafety goes false or something fails.
+static int TTServe_dispatch(TTServe_t *s, TTServeClient_t *stdio, int listenFd) {
+    size_t capacity = 16;
+    size_t clientCount = 0;
+    TTServeClient_t **clients = malloc(sizeof(TTServeClient_t *) * capacity);
+    struct pollfd *fds = malloc(sizeof(struct pollfd) * (capacity + 1));
+    if (!clients || !fds) {
+        free(clients);
+        free(fds);
+        return ENOMEM;
+    }
+    if (stdio)
+        clients[clientCount++] = stdio;
+    
+    int err = 0;
+    bool done = false;
+    while (!err && !done && catexit_loopSafety) {
+        // Room for every client and one more accepted below
+        if (clientCount == capacity) {
+            size_t cap = capacity * 2;
+            TTServeClient_t **cs = realloc(clients, sizeof(TTServeClient_t *) * cap);
+            if (cs)
+                clients = cs;
+            struct pollfd *fs = cs ? realloc(fds, sizeof(struct pollfd) * (cap + 1)) : NULL;
+            if (!fs) {
+                err = ENOMEM;
+                break;
+            }
+            fds = fs;
+            capacity = cap;
+        }
+        
+        size_t fdCount = 0;
+        if (listenFd >= 0)
+            fds[fdCount++] = (struct pollfd) { .fd = listenFd, .events = POLLIN, .revents = 0 };
+        for (size_t i = 0; i < clientCount; i++)
+            fds[fdCount++] = (struct pollfd) { .fd = clients[i]->inFd, .events = POLLIN, .revents = 0 };
+        
+        // Wake up now and then to notice being interrupted
+        int ready = poll(fds, fdCount, 250);
+        if (ready < 0) {
+            if (errno != EINTR)
+                err = errno;
+            continue;
+        }
+        
+        size_t f = 0;
+        if (listenFd >= 0 && fds[f++].revents & POLLIN) {
+            int fd = accept(listenFd, NULL, NULL);
+            TTServeClient_t *c = fd >= 0 ? TTServe_newClient(fd, fd, true) : NULL;
+            if (c)
+                clients[clientCount++] = c;
+            else if (fd >= 0)
+                close(fd);
+        }
+        
+        // Connections that ended or sent something unreasonable are dropped without taking the server down
+        size_t kept = 0;
+        for (size_t i = 0; i < fdCount - f; i++) {
+            TTServeClient_t *c = clients[i];
+            int re = fds[f + i].revents ? TTServe_read(s, c) : 0;
+            if (!re) {
+                clients[kept++] = c;
+                continue;
+            }
+            
+            if (c == stdio) {
+                done = true;
+                err = re < 0 ? 0 : re;
+            } else
+                TTServe_release(s, c);
+        }
+        memmove(&clients[kept], &clients[fdCount - f], sizeof(TTServeClient_t *) * (clientCount - (fdCount - f)));
+        clientCount = kept + clientCount - (fdCount - f);
+    }
+    
+    // stdin is released by the caller
+    for (size_t i = 0; i < clientCount; i++)
+        if (clients[i] != stdio)
+            TTServe_release(s, clients[i]);
+    free(clients);
+    free(fds);
+    
+    return err;
+}
+
+static int TTServe_listen(char *path, int *outFd) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return ENAMETOOLONG;
+    strcpy(addr.sun_path, path);
+    
+    // A socket left behind by a server that is gone is replaced but one still answering is not
+    struct stat st;
+    if (!lstat(path, &st) && S_ISSOCK(st.st_mode)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = probe >= 0 && !connect(probe, (struct sockaddr *) &addr, sizeof(addr));
+        if (probe >= 0)
+            close(probe);
+        if (live)
+            return EADDRINUSE;
+        unlink(path);
+    }
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return errno;
+    // Only the user running the server may connect. The socket file takes its mode from the umask when bind makes it,
+    // which is changed for the call alone since no other thread runs yet.
+    mode_t oldMask = umask(S_IRWXG | S_IRWXO);
+    int be = bind(fd, (struct sockaddr *) &addr, sizeof(addr));
+    umask(oldMask);
+    if (be || listen(fd, 64)) {
+        int err = errno;
+        close(fd);
+        return err;
+    }
+    *outFd = fd;
+    return 0;
+}
+#endif
+
+int TTServe_Run(char *socketPath, size_t threads, TTServeHandler_t handler, void *ctx) {
+#ifdef _WIN32
+    if (socketPath)
+        return ENOTSUP;
+#endif
+    
+    TTServe_t s = {
+        .head = NULL,
+        .tail = NULL,
+        .queued = 0,
+        .maxQueued = 0,
+        .stopping = false,
+        .handler = handler,
+        .ctx = ctx
+    };
+    if (pthread_mutex_init(&s.lock, NULL))
+        return EAGAIN;
+    if (pthread_cond_init(&s.ready, NULL)) {
+        pthread_mutex_destroy(&s.lock);
+        return EAGAIN;
+    }
+    if (pthread_cond_init(&s.space, NULL)) {
+        pthread_cond_destroy(&s.ready);
+        pthread_mutex_destroy(&s.lock);
+        return EAGAIN;
+    }
+    
+#ifndef _WIN32
+    // A client or stdout going away mid write would otherwise kill the server with SIGPIPE. Writes then fail with EPIPE
+    // instead, which marks the client broken (see TTServe_write).
+    struct sigaction ignorePipe = { .sa_handler = SIG_IGN };
+    struct sigaction oldPipe;
+    sigemptyset(&ignorePipe.sa_mask);
+    sigaction(SIGPIPE, &ignorePipe, &oldPipe);
+#endif
+    
+    int err = 0;
+    int listenFd = -1;
+    TTServeClient_t *stdio = NULL;
+    if (socketPath) {
+#ifndef _WIN32
+        err = TTServe_listen(socketPath, &listenFd);
+#endif
+    } else if (!(stdio = TTServe_newClient(0, 1, false)))
+        err = ENOMEM;
+    
+    size_t workerCount = TTPool_ThreadCount(threads, SIZE_MAX);
+    TTServeWorker_t *workers = err ? NULL : malloc(sizeof(TTServeWorker_t) * workerCount);
+    size_t started = 0;
+    if (!err && !workers)
+        err = ENOMEM;
+    for (size_t t = 0; !err && t < workerCount; t++) {
+        workers[started] = (TTServeWorker_t) { .server = &s, .index = started };
+        if (!pthread_create(&workers[started].thread, NULL, TTServe_work, &workers[started]))
+            started++;
+    }
+    if (!err && !started)
+        err = EAGAIN;
+    s.maxQueued = started * TTSERVE_QUEUEPERWORKER;
+    
+    if (!err)
+        err = TTServe_dispatch(&s, stdio, listenFd);
+    
+    pthread_mutex_lock(&s.lock);
+    s.stopping = true;
+    pthread_cond_broadcast(&s.ready);
+    pthread_mutex_unlock(&s.lock);
+    for (size_t t = 0; t < started; t++)
+        pthread_join(workers[t].thread, NULL);
+    free(workers);
+    
+    if (stdio)
+        TTServe_release(&s, stdio);
+#ifndef _WIN32
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath);
+    }
+    sigaction(SIGPIPE, &oldPipe, NULL);
+#endif
+    pthread_cond_destroy(&s.space);
+    pthread_cond_destroy(&s.ready);
+    pthread_mutex_destroy(&s.lock);
+    
+    return err;
+}
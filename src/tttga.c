@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 Yonder
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <tttga.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <stdext.h>
+
+// Sizes of the fixed header and the "New TGA Format" footer, and the image and colour map types read here
+#define TTTGA_HDRSZ 18
+#define TTTGA_FTRSZ 26
+#define TTTGA_CMT_COLORMAP 1
+#define TTTGA_IMT_COLORMAPPED 1
+#define TTTGA_IMT_RLECOLORMAPPED 9
+
+static char *_TTTGAError_ToStr[9] = {
+    [TTTGA_E_SUCCESS] = "Success",
+    [TTTGA_E_TRUNCATED] = "File is too small for its header, colour map or pixels",
+    [TTTGA_E_NOTCOLORMAPPED] = "Not a colour mapped TGA",
+    [TTTGA_E_INVLDMAP] = "Invalid colour map (must have entries of 15, 16, 24 or 32 bits)",
+    [TTTGA_E_INVLDPXLDEP] = "Invalid pixel depth (must be 8 or 16 bit indices)",
+    [TTTGA_E_INVLDSIZE] = "Invalid width or height",
+    [TTTGA_E_RIGHTTOLEFT] = "Right to left pixel order is not supported",
+    [TTTGA_E_INVLDINDEX] = "Pixel indexes outside of the colour map",
+    [TTTGA_E_MEMFAIL] = "Failed to allocate memory"
+};
+
+FORCE_INLINE uint16_t TTTGA_readLE16(const uint8_t *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+FORCE_INLINE uint8_t TTTGA_expand5(uint32_t v) {
+    return (uint8_t) ((v << 3) | (v >> 2));
+}
+
+char *TTTGAError_ToStr(TTTGAError_t e) {
+    return e >= TTTGA_E_SUCCESS && e <= TTTGA_E_MEMFAIL ? _TTTGAError_ToStr[e] : "Unknown error";
+}
+
+// Turns the colour map into the B, G, R, A bytes of each entry. 15 and 16 bit entries are ARRRRRGG GGGBBBBB (little
+// endian) whose A bit only counts in 16 bit maps of images that say they have an alpha bit.
+static void TTTGA_expandMap(const uint8_t *map, size_t count, uint8_t entrySize, bool hasAlpha, uint8_t (*out)[4]) {
+    for (size_t e = 0; e < count; e++) {
+        switch (entrySize) {
+            case 15:
+            case 16: {
+                uint16_t v = TTTGA_readLE16(&map[e * 2]);
+                out[e][0] = TTTGA_expand5(v & 0x1F);
+                out[e][1] = TTTGA_expand5((v >> 5) & 0x1F);
+                out[e][2] = TTTGA_expand5((v >> 10) & 0x1F);
+                out[e][3] = entrySize == 16 && hasAlpha && !(v & 0x8000) ? 0 : 0xFF;
+                break;
+            }
+            case 24:
+                memcpy(out[e], &map[e * 3], 3);
+                out[e][3] = 0xFF;
+                break;
+            default:
+                memcpy(out[e], &map[e * 4], 4);
+                break;
+        }
+    }
+}
+
+// Reads the next index of an uncompressed or RLE image, which for RLE is either the next one of a raw packet or the
+// repeated one of a run packet. Returns false if the data runs out.
+FORCE_INLINE bool TTTGA_nextIndex(const uint8_t **src, const uint8_t *end, bool rle, size_t indexSz, size_t *packet,
+bool *run, uint32_t *index) {
+    if (rle && !*packet) {
+        if (*src >= end)
+            return false;
+        *run = **src & 0x80;
+        *packet = (**src & 0x7F) + 1u;
+        (*src)++;
+        if (*run) {
+            if ((size_t) (end - *src) < indexSz)
+                return false;
+            *index = indexSz == 1 ? **src : TTTGA_readLE16(*src);
+            *src += indexSz;
+        }
+    }
+    if (rle)
+        (*packet)--;
+    if (rle && *run)
+        return true;
+    
+    if ((size_t) (end - *src) < indexSz)
+        return false;
+    *index = indexSz == 1 ? **src : TTTGA_readLE16(*src);
+    *src += indexSz;
+    return true;
+}
+
+TTTGAError_t TTTGA_ReadColorMapped(TGA_t *tga, TTTGAIndexed_t *indexed, size_t size, const uint8_t *data) {
+    if (size < TTTGA_HDRSZ)
+        return TTTGA_E_TRUNCATED;
+    
+    uint8_t idLength = data[0];
+    uint8_t colorMapType = data[1];
+    uint8_t imageType = data[2];
+    uint16_t firstEntry = TTTGA_readLE16(&data[3]);
+    uint16_t mapLength = TTTGA_readLE16(&data[5]);
+    uint8_t entrySize = data[7];
+    uint16_t width = TTTGA_readLE16(&data[12]);
+    uint16_t height = TTTGA_readLE16(&data[14]);
+    uint8_t pixelDepth = data[16];
+    uint8_t imageDesc = data[17];
+    if (colorMapType != TTTGA_CMT_COLORMAP || (imageType != TTTGA_IMT_COLORMAPPED &&
+        imageType != TTTGA_IMT_RLECOLORMAPPED))
+        return TTTGA_E_NOTCOLORMAPPED;
+    if (!mapLength || (entrySize != 15 && entrySize != 16 && entrySize != 24 && entrySize != 32))
+        return TTTGA_E_INVLDMAP;
+    if (pixelDepth != 8 && pixelDepth != 16)
+        return TTTGA_E_INVLDPXLDEP;
+    if (!width || !height)
+        return TTTGA_E_INVLDSIZE;
+    if (imageDesc & 0x10)
+        return TTTGA_E_RIGHTTOLEFT;
+    
+    size_t mapOffset = TTTGA_HDRSZ + idLength;
+    size_t mapSz = (size_t) mapLength * ((entrySize + 7u) / 8);
+    if (size < mapOffset + mapSz)
+        return TTTGA_E_TRUNCATED;
+    
+    bool isNewFmt = size >= TTTGA_HDRSZ + TTTGA_FTRSZ && !memcmp(&data[size - 18], TGA_FOOTERSIG, 18);
+    const uint8_t *src = &data[mapOffset + mapSz];
+    const uint8_t *end = &data[isNewFmt ? size - TTTGA_FTRSZ : size];
+    if (src > end)
+        return TTTGA_E_TRUNCATED;
+    
+    size_t pixelCount = (size_t) width * height;
+    char *id = idLength ? malloc(idLength + 1u) : NULL;
+    uint8_t (*map)[4] = malloc((size_t) mapLength * 4);
+    uint8_t *pixels = malloc(pixelCount * 4);
+    uint16_t *indices = indexed ? malloc(pixelCount * sizeof(uint16_t)) : NULL;
+    if ((idLength && !id) || !map || !pixels || (indexed && !indices)) {
+        free(id);
+        free(map);
+        free(pixels);
+        free(indices);
+        return TTTGA_E_MEMFAIL;
+    }
+    TTTGA_expandMap(&data[mapOffset], mapLength, entrySize, imageDesc & 0xF, map);
+    
+    bool rle = imageType == TTTGA_IMT_RLECOLORMAPPED;
+    size_t indexSz = pixelDepth / 8u;
+    size_t packet = 0;
+    bool run = false;
+    uint32_t index = 0;
+    TTTGAError_t err = TTTGA_E_SUCCESS;
+    for (size_t p = 0; p < pixelCount && !err; p++) {
+        if (!TTTGA_nextIndex(&src, end, rle, indexSz, &packet, &run, &index))
+            err = TTTGA_E_TRUNCATED;
+        else if (index < firstEntry || index - firstEntry >= mapLength)
+            err = TTTGA_E_INVLDINDEX;
+        else {
+            memcpy(&pixels[p * 4], map[index - firstEntry], 4);
+            if (indices)
+                indices[p] = (uint16_t) (index - firstEntry);
+        }
+    }
+    if (err || !indexed)
+        free(map);
+    if (err) {
+        free(id);
+        free(pixels);
+        free(indices);
+        return err;
+    }
+    
+    if (id) {
+        memcpy(id, &data[TTTGA_HDRSZ], idLength);
+        id[idLength] = '\0';
+    }
+    *tga = (TGA_t) {
+        .hdr = {
+            .idLength = idLength,
+            .colorMapType = colorMapType,
+            .imageType = TGA_IMT_COLOR,
+            .colorMapSpec = {
+                .firstEntryIndex = firstEntry,
+                .colorMapLength = mapLength,
+                .colorMapEntrySize = entrySize
+            },
+            .imageSpec = {
+                .xOrigin = TTTGA_readLE16(&data[8]),
+                .yOrigin = TTTGA_readLE16(&data[10]),
+                .width = width,
+                .height = height,
+                .pixelDepth = 32,
+                .imageDesc = TGAImageDescriptor(8, false, imageDesc & 0x20, 0)
+            }
+        },
+        .id = id,
+        .dataSz = pixelCount * 4,
+        .data = pixels,
+        .isNewFmt = isNewFmt
+    };
+    if (indexed)
+        *indexed = (TTTGAIndexed_t) { .mapLength = mapLength, .map = map, .indices = indices };
+    return TTTGA_E_SUCCESS;
+}
+
+void TTTGA_FreeIndexed(TTTGAIndexed_t *indexed) {
+    free(indexed->map);
+    free(indexed->indices);
+    *indexed = (TTTGAIndexed_t) { 0 };
+}
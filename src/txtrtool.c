@@ -23,8 +23,25 @@
  */
 
 #include <txtrtool.h>
+#include <ttfs.h>
+#include <ttpool.h>
+#include <ttmap.h>
+#include <ttio.h>
+#include <ttcache.h>
+#include <ttbench.h>
+#include <ttinfo.h>
+#include <ttisa.h>
+#include <ttresize.h>
+#include <ttgx.h>
+#include <ttquant.h>
+#include <ttjson.h>
+#include <ttserve.h>
+#include <ttarena.h>
+#include <ttdds.h>
+#include <tttga.h>
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -38,6 +55,7 @@
 #include <optparse99.h>
 #include <tga.h>
 #include <txtr.h>
+#include <stb_image_resize2.h>
 
 #if (defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_MISC)) && !defined(TXTR_INCLUDE_DECODE)
 #error TXTR decoding capabilities are required
@@ -57,10 +75,7 @@
 
 // TODO: handle premultiplied alpha
 // TODO: add better support for TGA format (convert to and from 32bit BGRA, support footer, etc.)
-// TODO: add option to intake TGA's palette (and convert it to BGRA) which will make the quantizer not run and instead
-// all colors will be collected for the palette instead.
 // TODO: Add option to put dithering on all forms of texture formats
-// TODO: Add validation logic to print
 
 typedef enum TTMode {
     TTM_SZ_MIN = SIG_ATOMIC_MIN,
@@ -68,13 +83,38 @@ typedef enum TTMode {
     TTM_DECODE,
     TTM_ENCODE,
     TTM_PRINT,
+    TTM_BATCHENCODE,
+    TTM_BATCHDECODE,
+    TTM_BENCH,
+    TTM_SERVE,
+    TTM_THUMB,
     TTM_SZ_MAX = SIG_ATOMIC_MAX
 } PACK TTMode_t;
 
 // A safe single thread volatile variable modified by only a single instruction so therefore it is re-entrant as well.
 static volatile sig_atomic_t ttMode = TTM_NONE;
 
+// --isa, kept outside of main since version needs it while options are still being parsed
+static char *ttISA = NULL;
+
 // Subcommand options types
+#ifdef TXTRTOOL_INCLUDE_DECODE
+// A part of a mipmap in pixels from its top left
+typedef struct TTRect {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+} TTRect_t;
+
+// What decode writes: TGAs of RGBA8 pixels or, for CMP textures, a BC1 DDS holding the mipmaps' blocks as they are
+typedef enum TTDecodeFormat {
+    TTDF_INVALID = -1,
+    TTDF_TGA,
+    TTDF_DDS
+} TTDecodeFormat_t;
+#endif
+
 #ifdef TXTRTOOL_INCLUDE_DECODE
 typedef struct TTDecodeOptions {
     int noOutp;
@@ -82,9 +122,32 @@ typedef struct TTDecodeOptions {
     int yes;
     int no;
     int mipmaps;
+    uint8_t mip;
+    char *mipRange;
+    char *rect;
     char *prefix;
     char *suffix;
+    char *format;
+    int legacyOrigin;
+    int directDecode;
+    // The mipmaps --mip, --mips or --mipmaps select, 0 based and inclusive (see validateDecodeOptions)
+    uint8_t firstMip;
+    uint8_t lastMip;
+    TTRect_t rectDec;
+    TTDecodeFormat_t formatDec;
+    // Where the job's buffers come from, the heap if NULL
+    TTArena_t *arena;
 } TTDecodeOptions_t;
+
+typedef struct TTThumbOptions {
+    int noOutp;
+    int noErrp;
+    int yes;
+    int no;
+    uint16_t size;
+    int exact;
+    int legacyOrigin;
+} TTThumbOptions_t;
 #endif
 
 #ifdef TXTRTOOL_INCLUDE_ENCODE
@@ -117,7 +180,134 @@ typedef struct TTEncodeOptions {
     int squishClusterFit;
     int squishRangeFit;
     int squishIterClusterFit;
+    int concurrentMips;
+    int quantize;
+    int legacyOrigin;
+    uint16_t threads;
+    char *cacheDir;
+    uint16_t cacheSize;
+    TTCache_t *cache;
+    // Where the job's buffers come from, the heap if NULL
+    TTArena_t *arena;
+    // Where the job's mipmap resizes keep their samplers between jobs, nowhere if NULL. Only used with concurrentMips,
+    // without it TXTR_Encode resizes the mipmaps itself
+    TTResizeCache_t *resizeCache;
 } TTEncodeOptions_t;
+
+// A mipmap level's source pixels for encodeParallel. Level 0 borrows the TGA's pixels.
+typedef struct TTMipLevel {
+    uint16_t width;
+    uint16_t height;
+    size_t pixelsSz;
+    uint8_t *pixels;
+    TXTREncodeError_t error;
+} TTMipLevel_t;
+
+// A band of whole tile rows of one mipmap level encoded on its own by encodeParallel
+typedef struct TTMipBand {
+    uint8_t level;
+    uint16_t y;
+    uint16_t height;
+    TXTR_t txtr;
+    TXTRRawMipmap_t mips[11];
+    TXTREncodeError_t error;
+} TTMipBand_t;
+
+typedef struct TTMipEncode {
+    TXTRFormat_t texFmt;
+    TXTRPaletteFormat_t palFmt;
+    TGA_t *src;
+    TXTREncodeOptions_t *texOpts;
+    uint8_t levelCount;
+    TTMipLevel_t levels[11];
+    bool sharedLevels;
+    size_t bandCount;
+    TTMipBand_t *bands;
+    // Where the levels and bands are allocated from, the heap if NULL
+    TTArena_t *arena;
+    // Samplers for the resizes worker 0 does (the calling thread's, see TTPool_Run), none if NULL
+    TTResizeCache_t *resizeCache;
+} TTMipEncode_t;
+
+// One output of a multi target encode and the options it is encoded with
+typedef struct TTEncodeTarget {
+    TTEncodeOptions_t opts;
+    char *output;
+    TTStatus_t status;
+} TTEncodeTarget_t;
+
+// Mipmap levels resized once and shared by every target resized with the same edge mode and filter
+typedef struct TTMipPyramid {
+    TXTREncodeOptions_t texOpts;
+    TTMipEncode_t me;
+} TTMipPyramid_t;
+
+typedef struct TTTargetEncode {
+    TGA_t *src;
+    TTTGAIndexed_t *indexed;
+    TTEncodeTarget_t *targets;
+    TTMipPyramid_t **targetPyramids;
+} TTTargetEncode_t;
+#endif
+
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+typedef struct TTBatchOptions {
+    uint16_t jobs;
+    uint16_t memBudget;
+} TTBatchOptions_t;
+
+typedef struct TTBatchJob {
+    char *input;
+    char *output;
+    TTStatus_t status;
+} TTBatchJob_t;
+
+typedef struct TTBatch {
+    TTBatchJob_t *jobs;
+    size_t jobCount;
+    void *opts;
+    TTBudget_t *budget;
+    // One per worker, NULL if they could not be allocated
+    TTArena_t *arenas;
+    TTResizeCache_t *resizeCaches;
+} TTBatch_t;
+
+typedef struct TTServeOptions {
+    int noOutp;
+    int noErrp;
+    uint16_t jobs;
+    char *socket;
+} TTServeOptions_t;
+
+// What every serve job's options start out as before the job's own fields are applied
+typedef struct TTServer {
+    TTServeOptions_t *opts;
+#ifdef TXTRTOOL_INCLUDE_DECODE
+    TTDecodeOptions_t *decOpts;
+#endif
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+    TTEncodeOptions_t *encOpts;
+#endif
+    // One per worker, NULL if they could not be allocated
+    TTArena_t *arenas;
+    TTResizeCache_t *resizeCaches;
+} TTServer_t;
+
+typedef enum TTOptionFieldType {
+    TTOF_FLAG,
+    TTOF_STR,
+    TTOF_UINT8,
+    TTOF_UINT16
+} TTOptionFieldType_t;
+
+// An option a serve job or an encode target can set by name. name is the options struct's field name used by serve and
+// longName the command line option's name used by encode targets (NULL if targets can't set it).
+typedef struct TTOptionField {
+    char *name;
+    char *longName;
+    TTOptionFieldType_t type;
+    size_t offset;
+} TTOptionField_t;
 #endif
 
 #ifdef TXTRTOOL_INCLUDE_MISC
@@ -125,9 +315,48 @@ typedef struct TTPrintOptions {
     int noOutp;
     int noErrp;
     int json;
+    int validate;
 } TTPrintOptions_t;
 #endif
 
+#if defined(TXTRTOOL_INCLUDE_ENCODE) && defined(TXTRTOOL_INCLUDE_MISC)
+typedef struct TTBenchOptions {
+    int noOutp;
+    int noErrp;
+    int json;
+    uint16_t iterations;
+    uint8_t mipLimit;
+    char *texFmt;
+    int checkKernels;
+    int directDecode;
+} TTBenchOptions_t;
+
+// One combination of encode settings measured by bench
+typedef struct TTBenchCase {
+    TXTRFormat_t texFmt;
+    TXTRPaletteFormat_t palFmt;
+    GXDitherType_t ditherType;
+    int squishFit;
+    char *squishFitName;
+} TTBenchCase_t;
+#endif
+
+// TTS_* -> string
+#define __txtrtool_Status2Str_agrp__(e) [TTS_ ## e ] = TOSTR(TTS_ ## e)
+static char *_Status2Str[7] = {
+    __txtrtool_Status2Str_agrp__(SUCCESS),
+    __txtrtool_Status2Str_agrp__(ERROR),
+    __txtrtool_Status2Str_agrp__(PROGERROR),
+    __txtrtool_Status2Str_agrp__(ARGERROR),
+    __txtrtool_Status2Str_agrp__(IOERROR),
+    __txtrtool_Status2Str_agrp__(FMTERROR),
+    __txtrtool_Status2Str_agrp__(MEMERROR)
+};
+
+FORCE_INLINE char *Status2Str(TTStatus_t s) {
+    return s >= TTS_SUCCESS && s <= TTS_MEMERROR ? _Status2Str[s] : "INVALID";
+}
+
 // TXTR_TTF_* <-> string and TOSTR(*) where * is of TXTR_TTF_* all without an intermediate type.
 #define __txtrtool_fmtstrs_egrp__(e) e = TXTR_TTF_ ## e
 enum __txtrtool_fmtstrs__ {
@@ -367,6 +596,75 @@ FORCE_INLINE GXDitherType_t Str2DitherType(char *str) {
     TOSTR(SIERRA) \
     TOSTR(SIERRA_LITE)
 
+#ifdef TXTRTOOL_INCLUDE_DECODE
+// TTDF_* <-> string
+static char *_DecFmt2Str[2] = {
+    [TTDF_TGA] = "tga",
+    [TTDF_DDS] = "dds"
+};
+
+FORCE_INLINE char *DecFmt2Str(TTDecodeFormat_t f) {
+    return f >= TTDF_TGA && f <= TTDF_DDS ? _DecFmt2Str[f] : "invalid";
+}
+
+FORCE_INLINE TTDecodeFormat_t Str2DecFmt(char *str) {
+    for (TTDecodeFormat_t f = TTDF_TGA; f <= TTDF_DDS; f++)
+        if (!strcmp(str, DecFmt2Str(f)))
+            return f;
+    return TTDF_INVALID;
+}
+
+#define DecFmtList(d) \
+    "tga" d \
+    "dds"
+#endif
+    
+#define ISAList(d) \
+    "baseline" d \
+    "sse2" d \
+    "avx" d \
+    "avx2"
+
+// Job memory tasks
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+// A job's buffers come from its arena when it has one (batch and serve workers) and the heap otherwise. Arena buffers
+// are dropped all at once when the worker resets it after the job.
+FORCE_INLINE void *jobAlloc(TTArena_t *arena, size_t size) {
+    return arena ? TTArena_Alloc(arena, size) : malloc(size);
+}
+
+FORCE_INLINE void jobFree(TTArena_t *arena, void *p) {
+    if (!arena)
+        free(p);
+}
+
+// csprintf_s into a job buffer
+static char *jobPrintf(TTArena_t *arena, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (len < 0)
+        return NULL;
+    
+    char *str = jobAlloc(arena, (size_t) len + 1);
+    if (!str)
+        return NULL;
+    va_start(args, format);
+    vsnprintf(str, (size_t) len + 1, format, args);
+    va_end(args);
+    return str;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_DECODE
+// Frees mipmaps whose buffers came from arena (the heap if NULL)
+static void freeMips(TXTRMipmap_t *mips, size_t count, TTArena_t *arena) {
+    for (size_t m = 0; !arena && m < count; m++)
+        TXTRMipmap_free(&mips[m]);
+}
+#endif
+
 // Read file tasks
 #if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE) || defined(TXTRTOOL_INCLUDE_MISC)
 static TTStatus_t readFile(bool noErrp, char *input, size_t *outDataSz, uint8_t **outData) {
@@ -410,18 +708,31 @@ static TTStatus_t readFile(bool noErrp, char *input, size_t *outDataSz, uint8_t
 }
 #endif
 
-#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_MISC)
-static TTStatus_t readTXTR(bool noErrp, char *input, TXTR_t *txtr) {
-    uint8_t *txtrData = NULL;
-    size_t txtrDataSz = 0;
-    TTStatus_t rfe = readFile(noErrp, input, &txtrDataSz, &txtrData);
-    if (rfe)
-        return rfe;
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE) || defined(TXTRTOOL_INCLUDE_MISC)
+// Like readFile but the data is mapped instead of read into the heap. For inputs only parsed once and then dropped.
+// TXTR_Read and TGA_Read copy what they parse into their own allocations so on those paths this only saves the tool's
+// own copy of the file, the parsed data still takes as much memory as before. Only the paths that decode straight
+// from the mapping hold less.
+static TTStatus_t mapFile(bool noErrp, char *input, TTMap_t *outMap) {
+    int mfe = TTMap_Open(input, outMap);
+    if (mfe) {
+        sleprintf(noErrp, "ERROR: Failed to read input file \"%s\": %s\n", input, strerror(mfe));
+        return mfe == ENOMEM ? TTS_MEMERROR : TTS_IOERROR;
+    } else if (!outMap->size) {
+        sleprintf(noErrp, "ERROR: Input file \"%s\" is empty\n", input);
+        TTMap_Close(outMap);
+        return TTS_ARGERROR;
+    }
     
-    TXTRReadError_t tre = TXTR_Read(txtr, txtrDataSz, txtrData);
+    return TTS_SUCCESS;
+}
+#endif
+
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_MISC)
+static TTStatus_t parseTXTR(bool noErrp, TTMap_t *txtrMap, TXTR_t *txtr) {
+    TXTRReadError_t tre = TXTR_Read(txtr, txtrMap->size, txtrMap->data);
     if (tre) {
         sleprintf(noErrp, "ERROR: Failed to read TXTR data: %s\n", TXTRReadError_ToStr(tre));
-        free(txtrData);
         
         switch (tre) {
             case TXTR_RE_INVLDTEXFMT:
@@ -442,24 +753,124 @@ static TTStatus_t readTXTR(bool noErrp, char *input, TXTR_t *txtr) {
                 return TTS_PROGERROR;
         }
     }
-    free(txtrData);
     
     return TTS_SUCCESS;
 }
+
+static TTStatus_t readTXTR(bool noErrp, char *input, TXTR_t *txtr) {
+    TTMap_t txtrMap;
+    TTStatus_t mfe = mapFile(noErrp, input, &txtrMap);
+    if (mfe)
+        return mfe;
+    
+    // TXTR_Read keeps its own copy of everything it needs so the mapping can go right after
+    TTStatus_t pte = parseTXTR(noErrp, &txtrMap, txtr);
+    TTMap_Close(&txtrMap);
+    
+    return pte;
+}
+
+// Like isDirectDecode but judged from headers already parsed out of a file of size bytes
+static bool isDirectInfo(TTInfo_t *info, size_t size) {
+    if (!TTGX_CanDecode(info->hdr.format) || !info->hdr.width || !info->hdr.height || !info->hdr.mipCount ||
+        info->hdr.mipCount > 11)
+        return false;
+    
+    size_t need = TTINFO_HDRSZ;
+    uint16_t width = info->hdr.width;
+    uint16_t height = info->hdr.height;
+    for (uint32_t m = 0; m < info->hdr.mipCount; m++) {
+        need += TTGX_Size(info->hdr.format, width, height);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return need <= size;
+}
+
+// Whether the tool's own kernels (ttgx) can decode data straight from the file's bytes rather than TXTR_Decode from the
+// copy TXTR_Read makes. Indexed textures and anything too short for its mipmaps are left to the txtr library which also
+// reports what is wrong with them. Decoding only goes this way with --directdecode (see decodeMips).
+static bool isDirectDecode(size_t size, uint8_t *data) {
+    TTInfo_t info;
+    return !TTInfo_Parse(&info, size, data) && isDirectInfo(&info, size);
+}
+
+// The equivalent of TXTR_Decode without flips for data isDirectDecode accepted, but only for mipmaps firstMip to
+// lastMip. Every level's size follows from the header so the ones before firstMip are skipped without touching their
+// bytes. outCount is 0 if the texture has no mipmap firstMip. With rect (which must fit every level decoded) only the
+// tiles it touches are decoded and the mipmaps are that part alone. The mipmaps' buffers come from arena.
+static TXTRDecodeError_t decodeDirect(size_t size, uint8_t *data, uint8_t firstMip, uint8_t lastMip, TTRect_t *rect,
+TTArena_t *arena, TXTRMipmap_t mips[11], size_t *outCount) {
+    TTInfo_t info;
+    TTInfo_Parse(&info, size, data);
+    
+    size_t offset = TTINFO_HDRSZ;
+    uint16_t width = info.hdr.width;
+    uint16_t height = info.hdr.height;
+    for (uint8_t m = 0; m < firstMip && m < info.hdr.mipCount; m++) {
+        offset += TTGX_Size(info.hdr.format, width, height);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    
+    size_t count = firstMip < info.hdr.mipCount ? (lastMip < info.hdr.mipCount ? lastMip + 1u : info.hdr.mipCount) -
+        firstMip : 0;
+    for (size_t m = 0; m < count; m++) {
+        uint16_t mipWidth = rect ? rect->width : width;
+        uint16_t mipHeight = rect ? rect->height : height;
+        size_t mipSz = (size_t) mipWidth * mipHeight * 4;
+        mips[m] = (TXTRMipmap_t) {
+            .width = mipWidth,
+            .height = mipHeight,
+            .size = mipSz,
+            .data = jobAlloc(arena, mipSz)
+        };
+        if (!mips[m].data || !catexit_loopSafety) {
+            for (size_t n = 0; n <= m; n++)
+                jobFree(arena, mips[n].data);
+            return catexit_loopSafety ? TXTR_DE_MEMFAILMIP : TXTR_DE_INTERRUPTED;
+        }
+        
+        if (rect)
+            TTGX_DecodeRect(info.hdr.format, &data[offset], width, rect->x, rect->y, rect->width, rect->height,
+                mips[m].data);
+        else
+            TTGX_Decode(info.hdr.format, &data[offset], width, height, mips[m].data);
+        offset += TTGX_Size(info.hdr.format, width, height);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    
+    *outCount = count;
+    return TXTR_DE_SUCCESS;
+}
 #endif
 
 #ifdef TXTRTOOL_INCLUDE_ENCODE
-static TTStatus_t readTGA(bool noErrp, char *input, TGA_t *tga) {
-    uint8_t *tgaData = NULL;
-    size_t tgaDataSz = 0;
-    TTStatus_t rfe = readFile(noErrp, input, &tgaDataSz, &tgaData);
-    if (rfe)
-        return rfe;
+// indexed, if not NULL, gets the colour map and indices of a colour mapped TGA and is zeroed for any other
+static TTStatus_t readTGA(bool noErrp, char *input, TGA_t *tga, TTTGAIndexed_t *indexed) {
+    if (indexed)
+        *indexed = (TTTGAIndexed_t) { 0 };
+    TTMap_t tgaMap;
+    TTStatus_t mfe = mapFile(noErrp, input, &tgaMap);
+    if (mfe)
+        return mfe;
     
-    TGAReadError_t tre = TGA_Read(tga, tgaDataSz, tgaData);
+    // TGA_Read keeps its own copy of everything it needs so the mapping can go right after. Colour mapped TGAs are
+    // read by the tool instead, which expands them to 32 bit pixels.
+    TGAReadError_t tre = TGA_Read(tga, tgaMap.size, tgaMap.data);
+    if (tre == TGA_RE_CLRMAPPRESENT) {
+        TTTGAError_t rcme = TTTGA_ReadColorMapped(tga, indexed, tgaMap.size, tgaMap.data);
+        TTMap_Close(&tgaMap);
+        if (rcme) {
+            sleprintf(noErrp, "ERROR: Failed to read colour mapped TGA data: %s\n", TTTGAError_ToStr(rcme));
+            return rcme == TTTGA_E_MEMFAIL ? TTS_MEMERROR : TTS_FMTERROR;
+        }
+        tre = TGA_RE_SUCCESS;
+    } else
+        TTMap_Close(&tgaMap);
     if (tre) {
         sleprintf(noErrp, "ERROR: Failed to read TGA data: %s\n", TGAReadError_ToStr(tre));
-        free(tgaData);
         
         switch (tre) {
             case TGA_RE_CLRMAPPRESENT:
@@ -480,7 +891,6 @@ static TTStatus_t readTGA(bool noErrp, char *input, TGA_t *tga) {
                 return TTS_PROGERROR;
         }
     }
-    free(tgaData);
     
     // TODO: Remove this when support is added
     if (tga->isNewFmt)
@@ -493,8 +903,7 @@ static TTStatus_t readTGA(bool noErrp, char *input, TGA_t *tga) {
 
 // Write file tasks
 #if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
-static TTStatus_t writeFile(bool noOutp, bool noErrp, bool yes, bool no, char *output, size_t fileDataSz,
-uint8_t *fileData) {
+static TTStatus_t confirmOverwrite(bool noOutp, bool noErrp, bool yes, bool no, char *output) {
     bool outputIsDir = false;
     bool outputExists = !cfexists(output, &outputIsDir);
     if (outputExists) {
@@ -510,18 +919,20 @@ uint8_t *fileData) {
         }
     }
     
-    FILE *file;
-    if (cfopen(output, "wb", &file)) {
-        sleprintf(noErrp, "ERROR: Failed to open output file \"%s\": %s\n", output, strerror(errno));
-        return TTS_IOERROR;
-    }
+    return TTS_SUCCESS;
+}
+
+static TTStatus_t writeFileV(bool noOutp, bool noErrp, bool yes, bool no, char *output, TTIOVec_t *vecs,
+size_t vecCount) {
+    TTStatus_t coe = confirmOverwrite(noOutp, noErrp, yes, no, output);
+    if (coe)
+        return coe;
     
-    if (cfwrite(fileData, sizeof(uint8_t), fileDataSz, file)) {
-        sleprintf(noErrp, "ERROR: Failed to write output file \"%s\": %s\n", output, strerror(errno));
+    int wfe = TTIO_WriteFile(output, vecs, vecCount);
+    if (wfe) {
+        sleprintf(noErrp, "ERROR: Failed to write output file \"%s\": %s\n", output, strerror(wfe));
         return TTS_IOERROR;
     }
-    if (cfclose(file))
-        sleprintf(noErrp, "WARN: Failed to close output file \"%s\": %s\n", output, strerror(errno));
     
     return TTS_SUCCESS;
 }
@@ -558,19 +969,18 @@ TXTRRawMipmap_t mips[11]) {
         }
     }
     
-    TTStatus_t fwe = writeFile(noOutp, noErrp, yes, no, output, txtrDataSz, txtrData);
-    if (fwe) {
-        free(txtrData);
-        return fwe;
-    }
+    TTIOVec_t vec = { .data = txtrData, .size = txtrDataSz };
+    TTStatus_t fwe = writeFileV(noOutp, noErrp, yes, no, output, &vec, 1);
     free(txtrData);
     
-    return TTS_SUCCESS;
+    return fwe;
 }
 #endif
 
 #ifdef TXTRTOOL_INCLUDE_DECODE
-static TTStatus_t writeTGA(bool noOutp, bool noErrp, bool yes, bool no, char *output, char *id, TXTRMipmap_t *mip) {
+// With topOrigin the mipmap's rows are written top to bottom and the image descriptor says so, otherwise bottom to top
+static TTStatus_t writeTGA(bool noOutp, bool noErrp, bool yes, bool no, char *output, char *id, TXTRMipmap_t *mip,
+bool topOrigin) {
     TGA_t tga = {
         .hdr = {
             .idLength = strlen(id),
@@ -587,7 +997,7 @@ static TTStatus_t writeTGA(bool noOutp, bool noErrp, bool yes, bool no, char *ou
                 .width = mip->width,
                 .height = mip->height,
                 .pixelDepth = 32,
-                .imageDesc = TGAImageDescriptor(8, false, false, 0)
+                .imageDesc = TGAImageDescriptor(8, false, topOrigin, 0)
             }
         },
         .id = id,
@@ -628,20 +1038,232 @@ static TTStatus_t writeTGA(bool noOutp, bool noErrp, bool yes, bool no, char *ou
         }
     }
     
-    TTStatus_t fwe = writeFile(noOutp, noErrp, yes, no, output, tgaDataSz, tgaData);
-    if (fwe) {
-        free(tgaData);
-        return  fwe;
-    }
+    TTIOVec_t vec = { .data = tgaData, .size = tgaDataSz };
+    TTStatus_t fwe = writeFileV(noOutp, noErrp, yes, no, output, &vec, 1);
     free(tgaData);
     
-    return TTS_SUCCESS;
+    return fwe;
 }
 #endif
 
 // Subcommand tasks
 #ifdef TXTRTOOL_INCLUDE_DECODE
+// Whether rect lies inside mipmap level of a texture with hdr, which it trivially does if there is no such level
+static bool rectFits(TTRect_t *rect, TXTRHeader_t *hdr, uint8_t level) {
+    uint16_t width = hdr->width;
+    uint16_t height = hdr->height;
+    for (uint8_t m = 0; m < level; m++) {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return level >= hdr->mipCount || ((uint32_t) rect->x + rect->width <= width &&
+        (uint32_t) rect->y + rect->height <= height);
+}
+
+// Copies the rect part of mip into a buffer of its own, replacing mip's
+static TXTRDecodeError_t cropMip(TXTRMipmap_t *mip, TTRect_t *rect) {
+    size_t rowSz = (size_t) rect->width * 4;
+    uint8_t *data = malloc(rowSz * rect->height);
+    if (!data)
+        return TXTR_DE_MEMFAILMIP;
+    
+    for (size_t y = 0; y < rect->height; y++)
+        memcpy(&data[y * rowSz], &mip->data[((rect->y + y) * mip->width + rect->x) * 4], rowSz);
+    free(mip->data);
+    *mip = (TXTRMipmap_t) { .width = rect->width, .height = rect->height, .size = rowSz * rect->height, .data = data };
+    return TXTR_DE_SUCCESS;
+}
+
+// Reads input and decodes its mipmaps firstMip to lastMip (0 based) into mips, or with rect (only for a single
+// mipmap) just that part of it. outCount is 0 if the texture has no mipmap firstMip. The tool's own kernels decode into
+// buffers from arena but TXTR_Decode's are always on the heap so outArena is set to where they are for freeMips.
+// Indexed textures are decoded without the flip TXTR_Decode would do for them and outTopOrigin is set to say their
+// rows run the other way, unless legacyOrigin asks for the rows to be flipped. The tool's own kernels are only used
+// with allowDirect.
+static TTStatus_t decodeMips(bool noOutp, bool noErrp, char *input, uint8_t firstMip, uint8_t lastMip,
+TTRect_t *rect, bool legacyOrigin, bool allowDirect, TTArena_t *arena, TXTRMipmap_t mips[11], size_t *outCount,
+TTArena_t **outArena, bool *outTopOrigin) {
+    sloprintf(noOutp, "Reading input TXTR \"%s\"...\n", input);
+    
+    TTMap_t txtrMap;
+    TTStatus_t mfe = mapFile(noErrp, input, &txtrMap);
+    if (mfe)
+        return mfe;
+    
+    TTInfo_t info;
+    TXTR_t txtr;
+    bool direct = allowDirect && isDirectDecode(txtrMap.size, txtrMap.data);
+    if (direct)
+        TTInfo_Parse(&info, txtrMap.size, txtrMap.data);
+    else {
+        // TXTR_Read keeps its own copy of everything it needs so the mapping can go right after
+        TTStatus_t pte = parseTXTR(noErrp, &txtrMap, &txtr);
+        TTMap_Close(&txtrMap);
+        if (pte)
+            return pte;
+    }
+    
+    TXTRHeader_t *hdr = direct ? &info.hdr : &txtr.hdr;
+    if (rect && !rectFits(rect, hdr, firstMip)) {
+        sleprintf(noErrp, "ERROR: Rectangle %ux%u at %u,%u does not fit in mipmap %u\n", rect->width, rect->height,
+            rect->x, rect->y, firstMip + 1u);
+        if (direct)
+            TTMap_Close(&txtrMap);
+        else
+            TXTR_free(&txtr);
+        return TTS_ARGERROR;
+    }
+    
+    sloprintf(noOutp, "Decoding TXTR...\n");
+    
+    TXTRDecodeError_t tde;
+    if (direct) {
+        tde = decodeDirect(txtrMap.size, txtrMap.data, firstMip, lastMip, rect, arena, mips, outCount);
+        TTMap_Close(&txtrMap);
+        *outArena = arena;
+        *outTopOrigin = false;
+    } else {
+        // TXTR_Decode can only give the first mipmap or all of them so the ones outside the range are dropped and rect
+        // is cropped after. Indexed textures are single mipmaps whose palette is decoded once either way.
+        bool flip = TXTR_IsIndexed(txtr.hdr.format);
+        TXTRDecodeOptions_t texOpts = {
+            .flipX = false,
+            .flipY = flip && legacyOrigin,
+            .decAllMips = lastMip > 0
+        };
+        tde = TXTR_Decode(&txtr, mips, outCount, &texOpts);
+        TXTR_free(&txtr);
+        *outArena = NULL;
+        *outTopOrigin = flip && !legacyOrigin;
+        if (!tde) {
+            size_t kept = 0;
+            for (size_t m = 0; m < *outCount; m++) {
+                if (m < firstMip || m > lastMip)
+                    TXTRMipmap_free(&mips[m]);
+                else
+                    mips[kept++] = mips[m];
+            }
+            *outCount = kept;
+            
+            // rect counts rows in the order they are written, which is from the other end if they weren't flipped
+            for (size_t m = 0; rect && m < kept && !tde; m++) {
+                TTRect_t mipRect = *rect;
+                if (*outTopOrigin)
+                    mipRect.y = (uint16_t) (mips[m].height - rect->y - rect->height);
+                tde = cropMip(&mips[m], &mipRect);
+            }
+            for (size_t m = 0; tde && m < kept; m++)
+                TXTRMipmap_free(&mips[m]);
+        }
+    }
+    if (tde) {
+        sleprintf(noErrp, "ERROR: Failed to decode TXTR data: %s\n", TXTRDecodeError_ToStr(tde));
+        
+        switch (tde) {
+            case TXTR_DE_INVLDTEXFMT:
+            case TXTR_DE_INVLDPALFMT:
+            case TXTR_DE_INVLDTEXWIDTH:
+            case TXTR_DE_INVLDTEXHEIGHT:
+            case TXTR_DE_INVLDTEXMIPCNT:
+                return TTS_FMTERROR;
+            case TXTR_DE_MEMFAILPAL:
+            case TXTR_DE_MEMFAILMIP:
+            case TXTR_DE_INVLDTEXPAL:
+            case TXTR_DE_INVLDTEXMIPS:
+                return TTS_MEMERROR;
+            case TXTR_DE_INVLDPARAMS:
+                return TTS_ARGERROR;
+            case TXTR_DE_INTERRUPTED:
+            case TXTR_DE_FAILDECPAL:
+            default:
+                return TTS_PROGERROR;
+        }
+    }
+    
+    return TTS_SUCCESS;
+}
+
+// Writes the mipmaps firstMip to lastMip of a CMP input to output as a BC1 DDS. The blocks are only moved and byte
+// swapped (see TTDDS_CMPToBC1), never decoded, so nothing is lost and the cost is that of copying the file.
+static TTStatus_t decodeDDS(TTDecodeOptions_t *opts, char *input, char *output) {
+    bool outputIsDir = false;
+    if (!cfexists(output, &outputIsDir) && outputIsDir) {
+        sleprintf(opts->noErrp, "ERROR: Output file \"%s\" must be a file\n", output);
+        return TTS_PROGERROR;
+    }
+    
+    sloprintf(opts->noOutp, "Reading input TXTR \"%s\"...\n", input);
+    
+    TTMap_t txtrMap;
+    TTStatus_t mfe = mapFile(opts->noErrp, input, &txtrMap);
+    if (mfe)
+        return mfe;
+    
+    TTInfo_t info;
+    TTInfoError_t ipe = TTInfo_Parse(&info, txtrMap.size, txtrMap.data);
+    if (ipe || info.hdr.format != TXTR_TTF_CMP || !isDirectDecode(txtrMap.size, txtrMap.data)) {
+        if (ipe)
+            sleprintf(opts->noErrp, "ERROR: Failed to read TXTR data: %s\n", TTInfoError_ToStr(ipe));
+        else if (info.hdr.format != TXTR_TTF_CMP)
+            sleprintf(opts->noErrp, "ERROR: Input TXTR \"%s\" is %s; only %s textures can be written as DDS\n", input,
+                Tex2Str(info.hdr.format), Tex2Str(TXTR_TTF_CMP));
+        else
+            sleprintf(opts->noErrp, "ERROR: Input TXTR \"%s\" is too short for its mipmaps\n", input);
+        TTMap_Close(&txtrMap);
+        return TTS_FMTERROR;
+    }
+    
+    size_t offset = TTINFO_HDRSZ;
+    uint16_t width = info.hdr.width;
+    uint16_t height = info.hdr.height;
+    for (uint8_t m = 0; m < opts->firstMip && m < info.hdr.mipCount; m++) {
+        offset += TTGX_Size(TXTR_TTF_CMP, width, height);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    if (opts->firstMip >= info.hdr.mipCount) {
+        sleprintf(opts->noErrp, "ERROR: Input TXTR \"%s\" has no mipmap %u\n", input, opts->firstMip + 1u);
+        TTMap_Close(&txtrMap);
+        return TTS_ARGERROR;
+    }
+    uint32_t count = (opts->lastMip < info.hdr.mipCount ? opts->lastMip + 1u : info.hdr.mipCount) - opts->firstMip;
+    
+    size_t ddsSz = TTDDS_HDRSZ;
+    for (uint32_t m = 0, w = width, h = height; m < count; m++, w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1)
+        ddsSz += TTDDS_BC1Size((uint16_t) w, (uint16_t) h);
+    uint8_t *dds = jobAlloc(opts->arena, ddsSz);
+    if (!dds) {
+        sleprintf(opts->noErrp, "ERROR: Failed to allocate memory for DDS data\n");
+        TTMap_Close(&txtrMap);
+        return TTS_MEMERROR;
+    }
+    
+    sloprintf(opts->noOutp, "Transcoding %s to BC1...\n", Tex2Str(TXTR_TTF_CMP));
+    
+    TTDDS_WriteBC1(dds, width, height, count);
+    size_t ddsOffset = TTDDS_HDRSZ;
+    for (uint32_t m = 0; m < count; m++) {
+        TTDDS_CMPToBC1(&txtrMap.data[offset], width, height, &dds[ddsOffset]);
+        offset += TTGX_Size(TXTR_TTF_CMP, width, height);
+        ddsOffset += TTDDS_BC1Size(width, height);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    TTMap_Close(&txtrMap);
+    
+    sloprintf(opts->noOutp, "Writing %u mipmap%s to output DDS \"%s\"...\n", count, count != 1 ? "s" : "", output);
+    
+    TTIOVec_t vec = { .data = dds, .size = ddsSz };
+    TTStatus_t fwe = writeFileV(opts->noOutp, opts->noErrp, opts->yes, opts->no, output, &vec, 1);
+    jobFree(opts->arena, dds);
+    
+    return fwe;
+}
+
 static TTStatus_t decode(TTDecodeOptions_t *opts, char *input, char *output) {
+    if (opts->formatDec == TTDF_DDS)
+        return decodeDDS(opts, input, output);
+    
     char *mipFile = NULL, *mipFileEnd = NULL;
     bool outputIsDir = false;
     bool outputExists = !cfexists(output, &outputIsDir);
@@ -668,9 +1290,9 @@ static TTStatus_t decode(TTDecodeOptions_t *opts, char *input, char *output) {
         char *cfn = cfilename(input, &cfnPtr);
         if (cfnPtr) {
             if (output[strlen(output) - 1] != '/' || output[strlen(output) - 1] != '\\')
-                mipFile = csprintf_s("%s/%s%s%s00.tga", output, opts->prefix, cfn, opts->suffix);
+                mipFile = jobPrintf(opts->arena, "%s/%s%s%s00.tga", output, opts->prefix, cfn, opts->suffix);
             else
-                mipFile = csprintf_s("%s%s%s%s00.tga", output, opts->prefix, cfn, opts->suffix);
+                mipFile = jobPrintf(opts->arena, "%s%s%s%s00.tga", output, opts->prefix, cfn, opts->suffix);
             
             free(cfnPtr);
         } else {
@@ -694,107 +1316,495 @@ static TTStatus_t decode(TTDecodeOptions_t *opts, char *input, char *output) {
             return TTS_PROGERROR;
         }
         
-        mipFile = csprintf_s("%s", output);
+        mipFile = jobPrintf(opts->arena, "%s", output);
         if (!mipFile) {
             sleprintf(opts->noErrp, "ERROR: Failed to set output file path \"%s\"\n", output);
             return TTS_MEMERROR;
         }
     }
     
-    sloprintf(opts->noOutp, "Reading input TXTR \"%s\"...\n", input);
-    
-    TXTR_t txtr;
-    TTStatus_t tre = readTXTR(opts->noErrp, input, &txtr);
-    if (tre) {
-        free(mipFile);
-        return tre;
-    }
-    
-    sloprintf(opts->noOutp, "Decoding TXTR...\n");
-    
     TXTRMipmap_t mips[11];
     size_t mipsCount;
-    TXTRDecodeOptions_t texOpts = {
-        .flipX = false,
-        .flipY = TXTR_IsIndexed(txtr.hdr.format),
-        .decAllMips = opts->mipmaps
-    };
-    TXTRDecodeError_t tde = TXTR_Decode(&txtr, mips, &mipsCount, &texOpts);
-    if (tde) {
-        sleprintf(opts->noErrp, "ERROR: Failed to decode TXTR data: %s\n", TXTRDecodeError_ToStr(tde));
-        free(mipFile);
-        TXTR_free(&txtr);
-        
-        switch (tde) {
-            case TXTR_DE_INVLDTEXFMT:
-            case TXTR_DE_INVLDPALFMT:
-            case TXTR_DE_INVLDTEXWIDTH:
-            case TXTR_DE_INVLDTEXHEIGHT:
-            case TXTR_DE_INVLDTEXMIPCNT:
-                return TTS_FMTERROR;
-            case TXTR_DE_MEMFAILPAL:
-            case TXTR_DE_MEMFAILMIP:
-            case TXTR_DE_INVLDTEXPAL:
-            case TXTR_DE_INVLDTEXMIPS:
-                return TTS_MEMERROR;
-            case TXTR_DE_INVLDPARAMS:
-                return TTS_ARGERROR;
-            case TXTR_DE_INTERRUPTED:
-            case TXTR_DE_FAILDECPAL:
-            default:
-                return TTS_PROGERROR;
-        }
+    TTArena_t *mipsArena;
+    bool topOrigin;
+    TTStatus_t dme = decodeMips(opts->noOutp, opts->noErrp, input, opts->firstMip, opts->lastMip,
+        opts->rect ? &opts->rectDec : NULL, opts->legacyOrigin, opts->directDecode, opts->arena, mips, &mipsCount,
+        &mipsArena, &topOrigin);
+    if (dme) {
+        jobFree(opts->arena, mipFile);
+        return dme;
+    }
+    
+    if (!mipsCount) {
+        sleprintf(opts->noErrp, "ERROR: Input TXTR \"%s\" has no mipmap %u\n", input, opts->firstMip + 1u);
+        jobFree(opts->arena, mipFile);
+        return TTS_ARGERROR;
     }
-    TXTR_free(&txtr);
     
     char *iToC = /* major */ "00000000011" /* minor */ "12345678901";
     for (size_t m = 0; catexit_loopSafety && m < mipsCount; m++) {
+        size_t level = opts->firstMip + m;
         if (opts->mipmaps) {
-            mipFileEnd[0] = iToC[m];
-            mipFileEnd[1] = iToC[11 + m];
+            mipFileEnd[0] = iToC[level];
+            mipFileEnd[1] = iToC[11 + level];
         }
         
-        sloprintf(opts->noOutp, "Writing mipmap %zu to output TGA \"%s\"\n", m + 1, mipFile);
+        sloprintf(opts->noOutp, "Writing mipmap %zu to output TGA \"%s\"\n", level + 1, mipFile);
         
-        TTStatus_t twe = writeTGA(opts->noOutp, opts->noErrp, opts->yes, opts->no, mipFile, TT_TITLE, &mips[m]);
+        TTStatus_t twe = writeTGA(opts->noOutp, opts->noErrp, opts->yes, opts->no, mipFile, TT_TITLE, &mips[m],
+            topOrigin);
         if (twe) {
-            free(mipFile);
-            for (size_t m = 0; m < mipsCount; m++)
-                TXTRMipmap_free(&mips[m]);
+            jobFree(opts->arena, mipFile);
+            freeMips(mips, mipsCount, mipsArena);
             return twe;
         }
     }
-    free(mipFile);
-    for (size_t m = 0; m < mipsCount; m++)
-        TXTRMipmap_free(&mips[m]);
+    jobFree(opts->arena, mipFile);
+    freeMips(mips, mipsCount, mipsArena);
     
     return TTS_SUCCESS;
 }
-#endif
 
-#ifdef TXTRTOOL_INCLUDE_ENCODE
-static TTStatus_t encode(TTEncodeOptions_t *opts, char *input, char *output) {
-    bool inputIsDir = false;
-    bool inputExists = !cfexists(input, &inputIsDir);
-    if (inputExists && inputIsDir) {
-        sleprintf(opts->noErrp, "ERROR: Input file \"%s\" must be a file\n", input);
+// Decodes only the smallest mipmap whose longer edge is at least opts->size, which the header alone decides, so the
+// cost follows the thumbnail's size rather than the texture's. With --exact it is then resized the rest of the way
+// down keeping its aspect ratio. Textures smaller than the size give their first mipmap as is.
+static TTStatus_t thumb(TTThumbOptions_t *opts, char *input, char *output) {
+    bool outputIsDir = false;
+    bool outputExists = !cfexists(output, &outputIsDir);
+    if (outputExists && outputIsDir) {
+        sleprintf(opts->noErrp, "ERROR: Output file \"%s\" must be a file\n", output);
         return TTS_PROGERROR;
     }
     
-    char *cdn = NULL;
-    char *outputDir = cdirname(output, &cdn);
-    if (cdn) {
-        bool outputDirIsDir = false;
-        bool outputDirExists = !cfexists(outputDir, &outputDirIsDir);
-        if (!outputDirExists) {
-            sloprintf(opts->no || opts->yes || opts->noOutp, "Output file's directory \"%s\" does not exist. Create "
-                "it? (y,Y/ANY) ", outputDir);
-            if (opts->no || askYN(opts->yes, opts->noOutp)) {
-                sleprintf(opts->noErrp, "ERROR: Not creating output file's directory \"%s\"\n", outputDir);
-                free(cdn);
-                return TTS_PROGERROR;
-            } else {
-                if (cmkdir(outputDir)) {
+    TTInfo_t info;
+    TTInfoError_t tie = TTInfo_Read(&info, input);
+    if (tie == TTI_E_IO) {
+        sleprintf(opts->noErrp, "ERROR: Failed to read input file \"%s\": %s\n", input, strerror(errno));
+        return TTS_IOERROR;
+    } else if (tie) {
+        sleprintf(opts->noErrp, "ERROR: Failed to read TXTR header: %s\n", TTInfoError_ToStr(tie));
+        return TTS_FMTERROR;
+    }
+    
+    uint8_t level = 0;
+    uint16_t width = info.hdr.width;
+    uint16_t height = info.hdr.height;
+    for (uint32_t m = 1; m < info.hdr.mipCount && m < 11; m++) {
+        uint16_t mipWidth = width > 1 ? width / 2 : 1;
+        uint16_t mipHeight = height > 1 ? height / 2 : 1;
+        if ((mipWidth > mipHeight ? mipWidth : mipHeight) < opts->size)
+            break;
+        level = (uint8_t) m;
+        width = mipWidth;
+        height = mipHeight;
+    }
+    
+    sloprintf(opts->noOutp, "Using mipmap %u (%ux%u) of %ux%u\n", level + 1u, width, height, info.hdr.width,
+        info.hdr.height);
+    
+    TXTRMipmap_t mips[11];
+    size_t mipCount;
+    TTArena_t *mipsArena;
+    bool topOrigin;
+    TTStatus_t dme = decodeMips(opts->noOutp, opts->noErrp, input, level, level, NULL, opts->legacyOrigin, false,
+        NULL, mips, &mipCount, &mipsArena, &topOrigin);
+    if (dme)
+        return dme;
+    if (!mipCount) {
+        sleprintf(opts->noErrp, "ERROR: Input TXTR \"%s\" has no mipmap %u\n", input, level + 1u);
+        return TTS_FMTERROR;
+    }
+    TXTRMipmap_t mip = mips[0];
+    
+    uint16_t longEdge = mip.width > mip.height ? mip.width : mip.height;
+    if (opts->exact && longEdge > opts->size) {
+        uint16_t thumbWidth = (uint16_t) (((uint32_t) mip.width * opts->size + longEdge / 2) / longEdge);
+        uint16_t thumbHeight = (uint16_t) (((uint32_t) mip.height * opts->size + longEdge / 2) / longEdge);
+        TXTRMipmap_t resized = {
+            .width = thumbWidth ? thumbWidth : 1,
+            .height = thumbHeight ? thumbHeight : 1
+        };
+        resized.size = (size_t) resized.width * resized.height * 4;
+        resized.data = malloc(resized.size);
+        if (!resized.data) {
+            sleprintf(opts->noErrp, "ERROR: Failed to allocate memory for thumbnail\n");
+            TXTRMipmap_free(&mip);
+            return TTS_MEMERROR;
+        }
+        
+        sloprintf(opts->noOutp, "Resizing to %ux%u...\n", resized.width, resized.height);
+        if (!TTResize(mip.data, mip.width, mip.height, 0, resized.data, resized.width, resized.height, 0,
+        STBIR_4CHANNEL, STBIR_TYPE_UINT8, STBIR_EDGE_CLAMP, STBIR_FILTER_DEFAULT)) {
+            sleprintf(opts->noErrp, "ERROR: Failed to resize thumbnail\n");
+            TXTRMipmap_free(&resized);
+            TXTRMipmap_free(&mip);
+            return TTS_PROGERROR;
+        }
+        TXTRMipmap_free(&mip);
+        mip = resized;
+    }
+    
+    sloprintf(opts->noOutp, "Writing thumbnail to output TGA \"%s\"\n", output);
+    
+    TTStatus_t twe = writeTGA(opts->noOutp, opts->noErrp, opts->yes, opts->no, output, TT_TITLE, &mip, topOrigin);
+    TXTRMipmap_free(&mip);
+    
+    return twe;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+// Number of mipmaps TXTR_Encode makes for a width x height source: halving until mipLimit is hit, a dimension would
+// go under its limit or 1x1 has been made.
+static uint8_t countMips(uint16_t width, uint16_t height, TXTREncodeOptions_t *texOpts) {
+    uint8_t count = 0;
+    while (count < texOpts->mipLimit && width >= texOpts->widthLimit && height >= texOpts->heightLimit) {
+        count++;
+        if (width == 1 && height == 1)
+            break;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return count;
+}
+
+// Allocates the buffers of every level after the first up front, on the calling thread since an arena is not thread
+// safe, for resizeMipJob to fill
+static TXTREncodeError_t allocMipLevels(TTMipEncode_t *me) {
+    for (uint8_t m = 1; m < me->levelCount; m++) {
+        TTMipLevel_t *ml = &me->levels[m];
+        ml->pixelsSz = (size_t) ml->width * ml->height * 4;
+        ml->pixels = jobAlloc(me->arena, ml->pixelsSz);
+        if (!ml->pixels)
+            return TXTR_EE_MEMFAILSRCPXS;
+    }
+    return TXTR_EE_SUCCESS;
+}
+
+static void resizeMipJob(void *ctx, size_t job, size_t worker) {
+    TTMipEncode_t *me = ctx;
+    TTMipLevel_t *ml = &me->levels[job + 1];
+    
+    // Every level is resized straight from the full size source so levels are independent. This is txtrtool's own
+    // resize, not TXTR_Encode's, so the level can differ in bytes from the one TXTR_Encode would have made. A cache
+    // is only safe to use from the thread it belongs to, the other workers build their samplers every time.
+    if (!TTResizeCache_Resize(worker ? NULL : me->resizeCache, me->src->data, me->src->hdr.imageSpec.width,
+    me->src->hdr.imageSpec.height, 0, ml->pixels, ml->width, ml->height, 0, STBIR_4CHANNEL, STBIR_TYPE_UINT8,
+    me->texOpts->stbirEdge, me->texOpts->stbirFilter)) {
+        ml->error = TXTR_EE_RESIZEFAIL;
+        return;
+    }
+    ml->error = TXTR_EE_SUCCESS;
+}
+
+static void encodeBandJob(void *ctx, size_t job, size_t worker) {
+    FAKEREF(worker);
+    TTMipEncode_t *me = ctx;
+    TTMipBand_t *mb = &me->bands[job];
+    TTMipLevel_t *ml = &me->levels[mb->level];
+    
+    // Bands are in output row order so when flipping the band's rows come from the other end of the source
+    size_t rowSz = (size_t) ml->width * 4;
+    size_t srcY = me->texOpts->flipY ? (size_t) ml->height - mb->y - mb->height : mb->y;
+    
+    TXTREncodeOptions_t bandOpts = *me->texOpts;
+    bandOpts.mipLimit = 1;
+    bandOpts.widthLimit = 1;
+    bandOpts.heightLimit = 1;
+    mb->error = TXTR_Encode(me->texFmt, me->palFmt, ml->width, mb->height, rowSz * mb->height,
+        ml->pixels + rowSz * srcY, &mb->txtr, mb->mips, &bandOpts);
+}
+
+// A few bands per thread evens out rows of cheap (flat) blocks against rows of expensive ones
+static size_t countBands(uint16_t height, size_t threads) {
+    size_t tileRows = (height + 7) / 8;
+    size_t bands = threads > 1 ? threads * 4 : 1;
+    return bands < tileRows ? bands : tileRows;
+}
+
+// Frees everything but the first band's TXTR which either becomes the result or is freed by the caller
+static void freeMipEncode(TTMipEncode_t *me) {
+    for (uint8_t m = 1; m < me->levelCount && !me->sharedLevels; m++)
+        jobFree(me->arena, me->levels[m].pixels);
+    for (size_t b = 0; b < me->bandCount; b++) {
+        if (me->bands[b].error)
+            continue;
+        if (me->bands[b].mips[0].data)
+            TXTRRawMipmap_free(&me->bands[b].mips[0]);
+        if (b)
+            TXTR_free(&me->bands[b].txtr);
+    }
+    jobFree(me->arena, me->bands);
+}
+
+// TXTR_Encode split into independent pieces run on the worker pool. With splitMips every mipmap level is resized from
+// the source and encoded on its own (otherwise only the first level is). CMP levels are further split into bands of
+// whole 8x8 tile rows since every CMP block is compressed on its own and a tile row's blocks are contiguous in the
+// output, so appending the bands is expected to give the bytes a single TXTR_Encode call would. This is unverified so
+// it only happens when more than one thread is asked for (--threads defaults to 1). sharedLevels, if not NULL, holds
+// the levels already resized (see encodeTargets) and is only borrowed. The resized levels and the bands come from
+// arena. resizeCache, if not NULL, keeps the samplers of the resizes done here for the next file of the same size. It
+// never decides whether the levels are resized here, so an encode's bytes don't depend on whether it had one.
+static TXTREncodeError_t encodeParallel(TXTRFormat_t texFmt, TXTRPaletteFormat_t palFmt, TGA_t *tga, TXTR_t *txtr,
+TXTRRawMipmap_t mips[11], TXTREncodeOptions_t *texOpts, bool splitMips, size_t threads, TTMipLevel_t *sharedLevels,
+TTArena_t *arena, TTResizeCache_t *resizeCache) {
+    uint16_t width = tga->hdr.imageSpec.width;
+    uint16_t height = tga->hdr.imageSpec.height;
+    uint8_t mipCount = countMips(width, height, texOpts);
+    bool splitBands = texFmt == TXTR_TTF_CMP && threads > 1;
+    // Without splitMips the levels after the first are left to TXTR_Encode's own resize so only a lone level splits
+    if (TXTR_IsIndexed(texFmt) || !mipCount || (mipCount > 1 ? !splitMips : !splitBands))
+        return TXTR_Encode(texFmt, palFmt, width, height, tga->dataSz, tga->data, txtr, mips, texOpts);
+    
+    TTMipEncode_t me = {
+        .texFmt = texFmt,
+        .palFmt = palFmt,
+        .src = tga,
+        .texOpts = texOpts,
+        .levelCount = mipCount,
+        .sharedLevels = !!sharedLevels,
+        .bandCount = 0,
+        .bands = NULL,
+        .arena = arena,
+        .resizeCache = resizeCache
+    };
+    size_t bandCount = 0;
+    for (uint8_t m = 0; m < mipCount; m++) {
+        me.levels[m] = (TTMipLevel_t) {
+            .width = width,
+            .height = height,
+            .pixelsSz = m ? 0 : tga->dataSz,
+            .pixels = m ? NULL : tga->data,
+            .error = m ? TXTR_EE_INTERRUPTED : TXTR_EE_SUCCESS
+        };
+        if (m && sharedLevels)
+            me.levels[m] = sharedLevels[m];
+        
+        bandCount += countBands(height, splitBands ? threads : 1);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    
+    me.bands = jobAlloc(arena, sizeof(TTMipBand_t) * bandCount);
+    if (!me.bands) {
+        freeMipEncode(&me);
+        return TXTR_EE_MEMFAILMIP;
+    }
+    for (uint8_t m = 0; m < mipCount; m++) {
+        size_t tileRows = (me.levels[m].height + 7) / 8;
+        size_t levelBands = countBands(me.levels[m].height, splitBands ? threads : 1);
+        for (size_t b = 0; b < levelBands; b++) {
+            size_t y = tileRows * b / levelBands * 8;
+            size_t yEnd = tileRows * (b + 1) / levelBands * 8;
+            if (yEnd > me.levels[m].height)
+                yEnd = me.levels[m].height;
+            me.bands[me.bandCount++] = (TTMipBand_t) {
+                .level = m,
+                .y = (uint16_t) y,
+                .height = (uint16_t) (yEnd - y),
+                .error = TXTR_EE_INTERRUPTED
+            };
+        }
+    }
+    
+    TXTREncodeError_t tee = mipCount > 1 && !sharedLevels ? allocMipLevels(&me) : TXTR_EE_SUCCESS;
+    if (!tee && mipCount > 1 && !sharedLevels) {
+        TTPool_Run(threads, mipCount - 1, resizeMipJob, &me);
+        for (uint8_t m = 1; m < mipCount && !tee; m++)
+            tee = me.levels[m].error;
+    }
+    if (!tee) {
+        TTPool_Run(threads, me.bandCount, encodeBandJob, &me);
+        for (size_t b = 0; b < me.bandCount && !tee; b++)
+            tee = me.bands[b].error;
+    }
+    if (tee) {
+        if (!me.bands[0].error)
+            TXTR_free(&me.bands[0].txtr);
+        freeMipEncode(&me);
+        return tee;
+    }
+    
+    // Stitch the bands of every level back together, handing over the buffer as is when a level is a single band
+    for (size_t b = 0, m = 0; m < mipCount; m++) {
+        size_t first = b, levelSz = 0;
+        for (; b < me.bandCount && me.bands[b].level == m; b++)
+            levelSz += me.bands[b].mips[0].size;
+        
+        if (b - first == 1) {
+            mips[m] = me.bands[first].mips[0];
+            me.bands[first].mips[0].data = NULL;
+            continue;
+        }
+        
+        uint8_t *levelData = malloc(levelSz);
+        if (!levelData) {
+            for (size_t fm = 0; fm < m; fm++)
+                TXTRRawMipmap_free(&mips[fm]);
+            TXTR_free(&me.bands[0].txtr);
+            freeMipEncode(&me);
+            return TXTR_EE_MEMFAILMIP;
+        }
+        mips[m].size = levelSz;
+        mips[m].data = levelData;
+        for (size_t bb = first; bb < b; bb++) {
+            memcpy(levelData, me.bands[bb].mips[0].data, me.bands[bb].mips[0].size);
+            levelData += me.bands[bb].mips[0].size;
+        }
+    }
+    
+    // The first band's header (and palette, if any) becomes the whole texture's
+    *txtr = me.bands[0].txtr;
+    txtr->hdr.height = tga->hdr.imageSpec.height;
+    txtr->hdr.mipCount = mipCount;
+    freeMipEncode(&me);
+    
+    return TXTR_EE_SUCCESS;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+FORCE_INLINE void toTexEncodeOptions(TTEncodeOptions_t *opts, TXTREncodeOptions_t *texOpts) {
+    *texOpts = (TXTREncodeOptions_t) {
+        .flipX = false,
+        .flipY = !TXTR_IsIndexed(opts->texFmtDec),
+        .mipLimit = opts->mipLimit,
+        .widthLimit = opts->widthLimit,
+        .heightLimit = opts->heightLimit,
+        .avgType = opts->avgTypeDec,
+        .squishFlags = opts->squishFlags,
+        .squishMetricSz = opts->squishMetricSz,
+        .squishMetric = opts->squishMetricPtr,
+        .stbirEdge = opts->stbirEdgeDec,
+        .stbirFilter = opts->stbirFilterDec,
+        .ditherType = opts->ditherTypeDec
+    };
+}
+
+// Non indexed formats are encoded with their rows flipped from a bottom to top TGA's. A TGA whose image descriptor says
+// its rows run top to bottom already has them the other way so the flip is only needed where it wasn't before, unless
+// legacyOrigin asks for the descriptor to be ignored.
+FORCE_INLINE bool encodeFlipY(TTEncodeOptions_t *opts, TGA_t *tga) {
+    bool topOrigin = !opts->legacyOrigin && (tga->hdr.imageSpec.imageDesc & TGAImageDescriptor(0, false, true, 0));
+    return !TXTR_IsIndexed(opts->texFmtDec) != topOrigin;
+}
+
+// Whether tga came from a colour map (see TTTGA_ReadColorMapped) that fits the palette of the indexed format being
+// encoded. Its pixels then already are what quantizing would make of them so neither the tool's quantizer nor any
+// dithering is run and they go to TXTR_Encode as they are.
+FORCE_INLINE bool fitsPalette(TTEncodeOptions_t *opts, TGA_t *tga) {
+    return tga->hdr.colorMapType != TGA_CMT_NOCOLORMAP && TXTR_IsIndexed(opts->texFmtDec) &&
+        tga->hdr.colorMapSpec.colorMapLength <= TTQuant_PaletteSize(opts->texFmtDec);
+}
+
+// With --quantize indexed formats are quantized and dithered by the tool (ttquant) before TXTR_Encode sees them, which
+// then only gets as many colours as its palette holds, already rounded to the palette format, and nothing to diffuse.
+// texOpts is switched to GX_DT_THRESHOLD to match.
+static TTStatus_t quantizePixels(TTEncodeOptions_t *opts, TXTREncodeOptions_t *texOpts, uint16_t width,
+uint16_t height, uint8_t *pixels) {
+    if (!opts->quantize || !TXTR_IsIndexed(opts->texFmtDec))
+        return TTS_SUCCESS;
+    
+    TTQuant_t quant;
+    int qbe = TTQuant_Build(&quant, pixels, (size_t) width * height, TTQuant_PaletteSize(opts->texFmtDec),
+        opts->palFmtDec);
+    int qde = qbe ? qbe : TTQuant_Dither(&quant, opts->ditherTypeDec, pixels, width, height,
+        opts->threads);
+    if (!qbe)
+        TTQuant_Free(&quant);
+    if (qde) {
+        sleprintf(opts->noErrp, "ERROR: Failed to quantize image: %s\n", strerror(qde));
+        return qde == ENOMEM ? TTS_MEMERROR : TTS_PROGERROR;
+    }
+    
+    texOpts->ditherType = GX_DT_THRESHOLD;
+    return TTS_SUCCESS;
+}
+
+// The key covers the source pixels and every option that changes the encoded bytes (but not ones like --threads which
+// don't). The tool version is part of it so entries from an older encoder are never reused. A colour map that
+// fitsPalette and its indices (see readTGA) are hashed in with the pixels.
+static TTStatus_t encodeCacheKey(TTEncodeOptions_t *opts, TGA_t *tga, TTTGAIndexed_t *indexed, TTCacheKey_t *outKey) {
+    float *metric = opts->squishMetricPtr ? opts->squishMetricPtr : (float[3]) { 0.0f, 0.0f, 0.0f };
+    char *desc = csprintf_s(TT_VERSION " %ux%u tex=%i pal=%i mips=%u wlim=%u hlim=%u avg=%i edge=%i filter=%i "
+        "dither=%i squish=%i metric=%zu:%a,%a,%a concurrentmips=%i quantize=%i colormap=%i flipy=%i",
+        tga->hdr.imageSpec.width, tga->hdr.imageSpec.height, (int) opts->texFmtDec, (int) opts->palFmtDec,
+        opts->mipLimit, opts->widthLimit, opts->heightLimit, (int) opts->avgTypeDec, (int) opts->stbirEdgeDec,
+        (int) opts->stbirFilterDec, (int) opts->ditherTypeDec, opts->squishFlags, opts->squishMetricSz,
+        (double) metric[0], (double) metric[1], (double) metric[2], opts->concurrentMips,
+        opts->quantize && TXTR_IsIndexed(opts->texFmtDec), fitsPalette(opts, tga), encodeFlipY(opts, tga));
+    if (!desc) {
+        sleprintf(opts->noErrp, "ERROR: Failed to allocate memory for cache key\n");
+        return TTS_MEMERROR;
+    }
+    
+    outKey->content = TTCache_Hash(tga->data, tga->dataSz, 0);
+    if (indexed && indexed->indices && fitsPalette(opts, tga)) {
+        outKey->content = TTCache_Hash(indexed->map, (size_t) indexed->mapLength * 4, outKey->content);
+        size_t indicesSz = (size_t) tga->hdr.imageSpec.width * tga->hdr.imageSpec.height * sizeof(*indexed->indices);
+        outKey->content = TTCache_Hash(indexed->indices, indicesSz, outKey->content);
+    }
+    outKey->options = TTCache_Hash(desc, strlen(desc), 0);
+    free(desc);
+    return TTS_SUCCESS;
+}
+
+static TTStatus_t openEncodeCache(TTEncodeOptions_t *opts, TTCache_t *cache) {
+    if (!opts->cacheDir)
+        return TTS_SUCCESS;
+    
+    int coe = TTCache_Open(cache, opts->cacheDir, (uint64_t) opts->cacheSize * 1024 * 1024);
+    if (coe) {
+        sleprintf(opts->noErrp, "ERROR: Failed to open cache \"%s\": %s\n", opts->cacheDir, strerror(coe));
+        return TTS_IOERROR;
+    }
+    opts->cache = cache;
+    return TTS_SUCCESS;
+}
+
+static void closeEncodeCache(TTEncodeOptions_t *opts) {
+    if (!opts->cache)
+        return;
+    
+    sloprintf(opts->noOutp, "Cache: %zu hit%s, %zu miss%s, %zu stored, %zu evicted\n", opts->cache->hits,
+        opts->cache->hits != 1 ? "s" : "", opts->cache->misses, opts->cache->misses != 1 ? "es" : "",
+        opts->cache->stores, opts->cache->evictions);
+    TTCache_Close(opts->cache);
+    opts->cache = NULL;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+// Checks input is a file and reads it (see readTGA)
+static TTStatus_t readEncodeInput(TTEncodeOptions_t *opts, char *input, TGA_t *tga, TTTGAIndexed_t *indexed) {
+    bool inputIsDir = false;
+    bool inputExists = !cfexists(input, &inputIsDir);
+    if (inputExists && inputIsDir) {
+        sleprintf(opts->noErrp, "ERROR: Input file \"%s\" must be a file\n", input);
+        return TTS_PROGERROR;
+    }
+    
+    sloprintf(opts->noOutp, "Reading input TGA \"%s\"...\n", input);
+    
+    return readTGA(opts->noErrp, input, tga, indexed);
+}
+
+// Makes sure the directory output goes in exists, asking before creating it
+static TTStatus_t prepareOutputDir(TTEncodeOptions_t *opts, char *output) {
+    char *cdn = NULL;
+    char *outputDir = cdirname(output, &cdn);
+    if (cdn) {
+        bool outputDirIsDir = false;
+        bool outputDirExists = !cfexists(outputDir, &outputDirIsDir);
+        if (!outputDirExists) {
+            sloprintf(opts->no || opts->yes || opts->noOutp, "Output file's directory \"%s\" does not exist. Create "
+                "it? (y,Y/ANY) ", outputDir);
+            if (opts->no || askYN(opts->yes, opts->noOutp)) {
+                sleprintf(opts->noErrp, "ERROR: Not creating output file's directory \"%s\"\n", outputDir);
+                free(cdn);
+                return TTS_PROGERROR;
+            } else {
+                if (cmkdir(outputDir)) {
                     sleprintf(opts->noErrp, "ERROR: Failed to create output file's directory \"%s\": %s\n", outputDir,
                         strerror(errno));
                     free(cdn);
@@ -802,164 +1812,1925 @@ static TTStatus_t encode(TTEncodeOptions_t *opts, char *input, char *output) {
                 }
             }
         }
-        free(cdn);
+        free(cdn);
+    }
+    
+    return TTS_SUCCESS;
+}
+
+static TTStatus_t encodeErrorStatus(TXTREncodeError_t tee) {
+    switch (tee) {
+        case TXTR_EE_SUCCESS:
+            return TTS_SUCCESS;
+        case TXTR_EE_MEMFAILSRCPXS:
+        case TXTR_EE_MEMFAILMIP:
+        case TXTR_EE_MEMFAILPAL:
+            return TTS_MEMERROR;
+        case TXTR_EE_INVLDPARAMS:
+        case TXTR_EE_INVLDTEXFMT:
+        case TXTR_EE_INVLDPALFMT:
+        case TXTR_EE_INVLDTEXWIDTH:
+        case TXTR_EE_INVLDTEXHEIGHT:
+        case TXTR_EE_INVLDTEXMIPLMT:
+        case TXTR_EE_INVLDTEXWIDTHLMT:
+        case TXTR_EE_INVLDTEXHEIGHTLMT:
+        case TXTR_EE_INVLDGXAVGTYPE:
+        case TXTR_EE_TRYMIPPALFMT:
+        case TXTR_EE_INVLDSTBIREDGEMODE:
+        case TXTR_EE_INVLDSTBIRFILTER:
+        case TXTR_EE_INVLDSQUISHMETRICSZ:
+        case TXTR_EE_INVLDGXDITHERTYPE:
+            return TTS_ARGERROR;
+        case TXTR_EE_FAILBUILDPAL:
+        case TXTR_EE_RESIZEFAIL:
+        case TXTR_EE_INTERRUPTED:
+        case TXTR_EE_FAILENCPAL:
+        default:
+            return TTS_PROGERROR;
+    }
+}
+
+// Encodes tga to output. With sharedSource tga is shared with other targets so it is never modified, and
+// sharedLevels, if not NULL, holds its mipmap levels already resized for opts. indexed, if not NULL, holds the colour
+// map and indices of a colour mapped tga (see readTGA) for the cache key.
+static TTStatus_t encodeTGA(TTEncodeOptions_t *opts, TGA_t *tga, TTTGAIndexed_t *indexed, char *output,
+bool sharedSource, TTMipLevel_t *sharedLevels) {
+    TTCacheKey_t cacheKey;
+    bool yes = opts->yes, no = opts->no;
+    if (opts->cache) {
+        // Asked now since a hit writes the output without going through writeTXTR
+        TTStatus_t coe = confirmOverwrite(opts->noOutp, opts->noErrp, yes, no, output);
+        if (coe)
+            return coe;
+        yes = true;
+        no = false;
+        
+        TTStatus_t cke = encodeCacheKey(opts, tga, indexed, &cacheKey);
+        if (cke)
+            return cke;
+        if (TTCache_Fetch(opts->cache, cacheKey, output)) {
+            sloprintf(opts->noOutp, "Copied cached TXTR to \"%s\"\n", output);
+            return TTS_SUCCESS;
+        }
+    }
+    
+    sloprintf(opts->noOutp, "Encoding TXTR...\n");
+    
+    TXTR_t txtr;
+    TXTRRawMipmap_t txtrMips[11];
+    TXTREncodeOptions_t texOpts;
+    toTexEncodeOptions(opts, &texOpts);
+    texOpts.flipY = encodeFlipY(opts, tga);
+    
+    // Quantizing changes the pixels so a shared source is quantized through a copy
+    TGA_t src = *tga;
+    uint8_t *quantized = NULL;
+    bool fits = fitsPalette(opts, tga);
+    if (fits && opts->ditherType && opts->ditherTypeDec != GX_DT_THRESHOLD)
+        sleprintf(opts->noErrp, "WARN: Not dithering \"%s\" with --dithertype %s since its colour map fits the %s "
+            "palette, %s is used instead\n", output, DitherType2Str(opts->ditherTypeDec), Tex2Str(opts->texFmtDec),
+            DitherType2Str(GX_DT_THRESHOLD));
+    if (fits)
+        texOpts.ditherType = GX_DT_THRESHOLD;
+    else if (sharedSource && opts->quantize && TXTR_IsIndexed(opts->texFmtDec)) {
+        quantized = jobAlloc(opts->arena, tga->dataSz);
+        if (!quantized) {
+            sleprintf(opts->noErrp, "ERROR: Failed to allocate memory for quantized pixels\n");
+            return TTS_MEMERROR;
+        }
+        memcpy(quantized, tga->data, tga->dataSz);
+        src.data = quantized;
+    }
+    TTStatus_t qpe = fits ? TTS_SUCCESS : quantizePixels(opts, &texOpts, src.hdr.imageSpec.width,
+        src.hdr.imageSpec.height, src.data);
+    if (qpe) {
+        jobFree(opts->arena, quantized);
+        return qpe;
+    }
+    TXTREncodeError_t tee = encodeParallel(opts->texFmtDec, opts->palFmtDec, &src, &txtr, txtrMips, &texOpts,
+        opts->concurrentMips, TTPool_ThreadCount(opts->threads, SIZE_MAX), sharedLevels, opts->arena,
+        opts->resizeCache);
+    jobFree(opts->arena, quantized);
+    if (tee) {
+        sleprintf(opts->noErrp, "ERROR: Failed to encode TXTR data: %s\n", TXTREncodeError_ToStr(tee));
+        return encodeErrorStatus(tee);
+    }
+    
+    sloprintf(opts->noOutp, "Writing %u mipmap%s to output TXTR \"%s\"...\n", txtr.hdr.mipCount,
+        txtr.hdr.mipCount != 1 ? "s" : "", output);
+    
+    TTStatus_t twe = writeTXTR(opts->noOutp, opts->noErrp, yes, no, output, &txtr, txtrMips);
+    TXTR_free(&txtr);
+    for (size_t m = 0; m < txtr.hdr.mipCount; m++)
+        TXTRRawMipmap_free(&txtrMips[m]);
+    if (twe)
+        return twe;
+    
+    if (opts->cache) {
+        int cse = TTCache_Store(opts->cache, cacheKey, output);
+        if (cse)
+            sleprintf(opts->noErrp, "WARN: Failed to store \"%s\" in the cache: %s\n", output, strerror(cse));
+    }
+    
+    return TTS_SUCCESS;
+}
+
+// Transcodes a BC1 DDS to a CMP TXTR holding the same mipmaps (up to 11) by moving and byte swapping the blocks (see
+// TTDDS_BC1ToCMP). Nothing is compressed again so it is lossless and takes none of squish's time, but neither can any
+// option besides the format apply; the DDS's mipmaps are kept as they are and the cache is not used.
+static TTStatus_t encodeDDS(TTEncodeOptions_t *opts, char *input, char *output) {
+    if (opts->texFmtDec != TXTR_TTF_CMP) {
+        sleprintf(opts->noErrp, "ERROR: DDS input \"%s\" can only be encoded to %s (--texfmt %s)\n", input,
+            Tex2Str(TXTR_TTF_CMP), Tex2Str(TXTR_TTF_CMP));
+        return TTS_ARGERROR;
+    }
+    
+    bool inputIsDir = false;
+    if (!cfexists(input, &inputIsDir) && inputIsDir) {
+        sleprintf(opts->noErrp, "ERROR: Input file \"%s\" must be a file\n", input);
+        return TTS_PROGERROR;
+    }
+    
+    sloprintf(opts->noOutp, "Reading input DDS \"%s\"...\n", input);
+    
+    TTMap_t ddsMap;
+    TTStatus_t mfe = mapFile(opts->noErrp, input, &ddsMap);
+    if (mfe)
+        return mfe;
+    
+    TTDDS_t dds;
+    TTDDSError_t dpe = TTDDS_ParseBC1(&dds, ddsMap.size, ddsMap.data);
+    if (dpe) {
+        sleprintf(opts->noErrp, "ERROR: Failed to read DDS data: %s\n", TTDDSError_ToStr(dpe));
+        TTMap_Close(&ddsMap);
+        return TTS_FMTERROR;
+    }
+    if (dds.mipCount > 11) {
+        sleprintf(opts->noErrp, "WARN: Input DDS \"%s\" has %u mipmaps; only the first 11 fit in a TXTR\n", input,
+            dds.mipCount);
+        dds.mipCount = 11;
+    }
+    
+    size_t cmpSz = 0;
+    for (uint32_t m = 0, w = dds.width, h = dds.height; m < dds.mipCount; m++, w = w > 1 ? w / 2 : 1,
+        h = h > 1 ? h / 2 : 1)
+        cmpSz += TTGX_Size(TXTR_TTF_CMP, (uint16_t) w, (uint16_t) h);
+    uint8_t *cmp = jobAlloc(opts->arena, cmpSz);
+    if (!cmp) {
+        sleprintf(opts->noErrp, "ERROR: Failed to allocate memory for %s data\n", Tex2Str(TXTR_TTF_CMP));
+        TTMap_Close(&ddsMap);
+        return TTS_MEMERROR;
+    }
+    
+    sloprintf(opts->noOutp, "Transcoding BC1 to %s...\n", Tex2Str(TXTR_TTF_CMP));
+    
+    TXTR_t txtr = {
+        .hdr = { .format = TXTR_TTF_CMP, .width = dds.width, .height = dds.height, .mipCount = dds.mipCount },
+        .isIndexed = false
+    };
+    TXTRRawMipmap_t txtrMips[11];
+    size_t ddsOffset = dds.dataOffset;
+    size_t cmpOffset = 0;
+    uint16_t width = dds.width;
+    uint16_t height = dds.height;
+    for (uint32_t m = 0; m < dds.mipCount; m++) {
+        txtrMips[m] = (TXTRRawMipmap_t) { .size = TTGX_Size(TXTR_TTF_CMP, width, height), .data = &cmp[cmpOffset] };
+        TTDDS_BC1ToCMP(&ddsMap.data[ddsOffset], width, height, txtrMips[m].data);
+        ddsOffset += TTDDS_BC1Size(width, height);
+        cmpOffset += txtrMips[m].size;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    TTMap_Close(&ddsMap);
+    
+    sloprintf(opts->noOutp, "Writing %u mipmap%s to output TXTR \"%s\"...\n", txtr.hdr.mipCount,
+        txtr.hdr.mipCount != 1 ? "s" : "", output);
+    
+    TTStatus_t twe = writeTXTR(opts->noOutp, opts->noErrp, opts->yes, opts->no, output, &txtr, txtrMips);
+    jobFree(opts->arena, cmp);
+    
+    return twe;
+}
+
+static TTStatus_t encode(TTEncodeOptions_t *opts, char *input, char *output) {
+    TTStatus_t pde = prepareOutputDir(opts, output);
+    if (pde)
+        return pde;
+    
+    if (TTFS_HasExt(input, ".dds"))
+        return encodeDDS(opts, input, output);
+    
+    TGA_t tga;
+    TTTGAIndexed_t indexed;
+    TTStatus_t tre = readEncodeInput(opts, input, &tga, &indexed);
+    if (tre)
+        return tre;
+    
+    TTStatus_t ete = encodeTGA(opts, &tga, &indexed, output, false, NULL);
+    TGA_free(&tga);
+    TTTGA_FreeIndexed(&indexed);
+    
+    return ete;
+}
+
+static void encodeTargetJob(void *ctx, size_t job, size_t worker) {
+    FAKEREF(worker);
+    TTTargetEncode_t *te = ctx;
+    TTEncodeTarget_t *target = &te->targets[job];
+    TTMipPyramid_t *pyramid = te->targetPyramids[job];
+    // Targets that failed before encoding (prompts, shared resize) are left as they are
+    if (target->status)
+        return;
+    target->status = encodeTGA(&target->opts, te->src, te->indexed, target->output, true,
+        pyramid ? pyramid->me.levels : NULL);
+}
+
+// Resizes the levels of a pyramid once for every target sharing it, the way encodeParallel does for one target
+static TXTREncodeError_t resizePyramid(TTMipPyramid_t *pyramid, TGA_t *tga, size_t threads) {
+    TTMipEncode_t *me = &pyramid->me;
+    uint16_t width = tga->hdr.imageSpec.width;
+    uint16_t height = tga->hdr.imageSpec.height;
+    for (uint8_t m = 0; m < me->levelCount; m++) {
+        me->levels[m] = (TTMipLevel_t) {
+            .width = width,
+            .height = height,
+            .pixelsSz = m ? 0 : tga->dataSz,
+            .pixels = m ? NULL : tga->data,
+            .error = m ? TXTR_EE_INTERRUPTED : TXTR_EE_SUCCESS
+        };
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    TXTREncodeError_t tee = allocMipLevels(me);
+    if (tee)
+        return tee;
+    TTPool_Run(threads, me->levelCount - 1, resizeMipJob, me);
+    
+    for (uint8_t m = 1; m < me->levelCount && !tee; m++)
+        tee = me->levels[m].error;
+    return tee;
+}
+
+// Reads input once and encodes it to every target still without a status
+static TTStatus_t encodeReadyTargets(TTEncodeOptions_t *opts, char *input, TTEncodeTarget_t *targets,
+size_t targetCount, size_t readyCount) {
+    TGA_t tga;
+    TTTGAIndexed_t indexed;
+    TTStatus_t tre = readEncodeInput(opts, input, &tga, &indexed);
+    if (tre)
+        return tre;
+    
+    TTMipPyramid_t *pyramids = malloc(sizeof(TTMipPyramid_t) * targetCount);
+    TTMipPyramid_t **targetPyramids = calloc(targetCount, sizeof(TTMipPyramid_t *));
+    if (!pyramids || !targetPyramids) {
+        sleprintf(opts->noErrp, "ERROR: Failed to allocate memory for encode targets\n");
+        free(pyramids);
+        free(targetPyramids);
+        TGA_free(&tga);
+        TTTGA_FreeIndexed(&indexed);
+        return TTS_MEMERROR;
+    }
+    
+    // Only targets that already have the tool resize their levels (--concurrentmips, see encodeParallel) share them so
+    // every target's bytes are what encoding it alone would give. The rest share the read source only.
+    size_t threads = TTPool_ThreadCount(opts->threads, SIZE_MAX);
+    size_t pyramidCount = 0;
+    for (size_t t = 0; t < targetCount; t++) {
+        TTEncodeTarget_t *target = &targets[t];
+        target->opts.threads = (uint16_t) (threads > readyCount ? threads / readyCount : 1);
+        TXTREncodeOptions_t texOpts;
+        toTexEncodeOptions(&target->opts, &texOpts);
+        uint8_t mipCount = countMips(tga.hdr.imageSpec.width, tga.hdr.imageSpec.height, &texOpts);
+        if (target->status || !target->opts.concurrentMips || TXTR_IsIndexed(target->opts.texFmtDec) || mipCount < 2)
+            continue;
+        
+        TTMipPyramid_t *pyramid = NULL;
+        for (size_t p = 0; p < pyramidCount && !pyramid; p++)
+            if (pyramids[p].texOpts.stbirEdge == texOpts.stbirEdge &&
+                pyramids[p].texOpts.stbirFilter == texOpts.stbirFilter)
+                pyramid = &pyramids[p];
+        if (!pyramid) {
+            pyramid = &pyramids[pyramidCount++];
+            pyramid->texOpts = texOpts;
+            pyramid->me = (TTMipEncode_t) {
+                .src = &tga,
+                .texOpts = &pyramid->texOpts,
+                .levelCount = 0,
+                .sharedLevels = false,
+                .bandCount = 0,
+                .bands = NULL,
+                .arena = NULL,
+                .resizeCache = opts->resizeCache
+            };
+        }
+        if (pyramid->me.levelCount < mipCount)
+            pyramid->me.levelCount = mipCount;
+        targetPyramids[t] = pyramid;
+    }
+    
+    sloprintf(opts->noOutp, "Encoding %zu target%s with %zu shared mipmap set%s...\n", readyCount,
+        readyCount != 1 ? "s" : "", pyramidCount, pyramidCount != 1 ? "s" : "");
+    
+    for (size_t p = 0; p < pyramidCount; p++) {
+        TXTREncodeError_t tee = resizePyramid(&pyramids[p], &tga, threads);
+        if (!tee)
+            continue;
+        
+        sleprintf(opts->noErrp, "ERROR: Failed to encode TXTR data: %s\n", TXTREncodeError_ToStr(tee));
+        for (size_t t = 0; t < targetCount; t++)
+            if (targetPyramids[t] == &pyramids[p])
+                targets[t].status = encodeErrorStatus(tee);
+    }
+    
+    TTTargetEncode_t te = {
+        .src = &tga,
+        .indexed = &indexed,
+        .targets = targets,
+        .targetPyramids = targetPyramids
+    };
+    TTPool_Run(threads, targetCount, encodeTargetJob, &te);
+    
+    for (size_t p = 0; p < pyramidCount; p++)
+        for (uint8_t m = 1; m < pyramids[p].me.levelCount; m++)
+            free(pyramids[p].me.levels[m].pixels);
+    free(pyramids);
+    free(targetPyramids);
+    TGA_free(&tga);
+    TTTGA_FreeIndexed(&indexed);
+    
+    return TTS_SUCCESS;
+}
+
+// Encodes one input to every target. The input is read once and, for targets with --concurrentmips, the mipmap levels
+// are resized once per edge mode and filter and shared between them. The targets are then encoded in parallel with the
+// threads split between them. The per-target statuses fold like a batch's.
+static TTStatus_t encodeTargets(TTEncodeOptions_t *opts, char *input, TTEncodeTarget_t *targets, size_t targetCount) {
+    // Every prompt is asked up front since the targets are written at the same time
+    size_t readyCount = 0;
+    for (size_t t = 0; t < targetCount; t++) {
+        TTEncodeTarget_t *target = &targets[t];
+        target->status = prepareOutputDir(opts, target->output);
+        if (!target->status)
+            target->status = confirmOverwrite(opts->noOutp, opts->noErrp, opts->yes, opts->no, target->output);
+        target->opts.yes = true;
+        target->opts.no = false;
+        target->opts.cache = opts->cache;
+        readyCount += !target->status;
+    }
+    
+    if (readyCount && TTFS_HasExt(input, ".dds")) {
+        // Transcoding costs about as much as reading the input so there is nothing to share between targets
+        for (size_t t = 0; t < targetCount; t++)
+            if (!targets[t].status)
+                targets[t].status = encodeDDS(&targets[t].opts, input, targets[t].output);
+    } else if (readyCount) {
+        TTStatus_t ete = encodeReadyTargets(opts, input, targets, targetCount, readyCount);
+        for (size_t t = 0; t < targetCount && ete; t++)
+            if (!targets[t].status)
+                targets[t].status = ete;
+    }
+    
+    TTStatus_t status = TTS_SUCCESS;
+    size_t failed = 0;
+    for (size_t t = 0; t < targetCount; t++) {
+        TTStatus_t ts = targets[t].status;
+        if (!ts)
+            continue;
+        
+        sleprintf(opts->noErrp, "ERROR: Failed on \"%s\": %s\n", targets[t].output, Status2Str(ts));
+        if (!failed++)
+            status = ts;
+        else if (status != ts)
+            status = TTS_ERROR;
+    }
+    
+    sloprintf(opts->noOutp, "Encoded %zu of %zu target%s successfully\n", targetCount - failed, targetCount,
+        targetCount != 1 ? "s" : "");
+    
+    return status;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_MISC
+static TTStatus_t print(TTPrintOptions_t *opts, char *input) {
+    sleprintf(opts->noErrp, "Reading input TXTR \"%s\"...\n", input);
+    
+    TTInfo_t info;
+    if (opts->validate) {
+        // Only a full read checks the palette and every mipmap are all there
+        TXTR_t txtr;
+        TTStatus_t tre = readTXTR(opts->noErrp, input, &txtr);
+        if (tre)
+            return tre;
+        info.hdr = txtr.hdr;
+        info.isIndexed = txtr.isIndexed;
+        info.palHdr = txtr.palHdr;
+        TXTR_free(&txtr);
+    } else {
+        TTInfoError_t tie = TTInfo_Read(&info, input);
+        if (tie == TTI_E_IO) {
+            sleprintf(opts->noErrp, "ERROR: Failed to read input file \"%s\": %s\n", input, strerror(errno));
+            return TTS_IOERROR;
+        } else if (tie) {
+            sleprintf(opts->noErrp, "ERROR: Failed to read TXTR header: %s\n", TTInfoError_ToStr(tie));
+            return TTS_FMTERROR;
+        }
+    }
+    
+    if (opts->json) {
+        sloprintf(opts->noOutp,
+            "{\n"
+            "    \"texture_format\": \"%s\",\n"
+            "    \"texture_width\": %u,\n"
+            "    \"texture_height\": %u,\n"
+            "    \"texture_mipmap_count\": %u,\n"
+            "    \"palette_format\": \"%s\",\n"
+            "    \"palette_width\": %u,\n"
+            "    \"palette_height\": %u\n"
+            "}\n",
+            Tex2Str(info.hdr.format),
+            info.hdr.width,
+            info.hdr.height,
+            info.hdr.mipCount,
+            info.isIndexed ? Pal2Str(info.palHdr.format) : "",
+            info.isIndexed ? info.palHdr.width : 0,
+            info.isIndexed ? info.palHdr.height : 0
+        );
+    } else {
+        sloprintf(opts->noOutp, "Texture format: %s\nTexture dimensions: %ux%u\nTexture mipmaps: %u\n",
+            Tex2Str(info.hdr.format), info.hdr.width, info.hdr.height, info.hdr.mipCount);
+        if (info.isIndexed)
+            sloprintf(opts->noOutp, "Palette format: %s\nPalette dimensions: %ux%u\n", Pal2Str(info.palHdr.format),
+                info.palHdr.width, info.palHdr.height);
+    }
+    
+    return TTS_SUCCESS;
+}
+#endif
+
+#if defined(TXTRTOOL_INCLUDE_ENCODE) && defined(TXTRTOOL_INCLUDE_MISC)
+// Prints str escaped for use inside a JSON string
+static void printJSONString(bool noOutp, char *str) {
+    for (; *str; str++) {
+        unsigned char ch = (unsigned char) *str;
+        if (ch == '"' || ch == '\\')
+            sloprintf(noOutp, "\\%c", ch);
+        else if (ch < 0x20)
+            sloprintf(noOutp, "\\u%04x", ch);
+        else
+            sloprintf(noOutp, "%c", ch);
+    }
+}
+
+// Every texture format once, indexed formats for every palette format and dither type, and CMP for every squish fit
+static TTBenchCase_t *listBenchCases(TXTRFormat_t only, size_t *outCount) {
+    static const struct { int flag; char *name; } fits[3] = {
+        { kColourRangeFit, "RANGE" },
+        { kColourClusterFit, "CLUSTER" },
+        { kColourIterativeClusterFit, "ITERATIVE_CLUSTER" }
+    };
+    TTBenchCase_t *cases = malloc(sizeof(TTBenchCase_t) * (TXTR_TTF_CMP + 1) * 3 * (GX_DT_MAX + 1));
+    if (!cases)
+        return NULL;
+    
+    size_t count = 0;
+    for (TXTRFormat_t t = TXTR_TTF_I4; t <= TXTR_TTF_CMP; t++) {
+        if (only != TXTR_TTF_INVALID && t != only)
+            continue;
+        
+        TTBenchCase_t c = {
+            .texFmt = t,
+            .palFmt = TXTR_TPF_INVALID,
+            .ditherType = GX_DT_INVALID,
+            .squishFit = 0,
+            .squishFitName = NULL
+        };
+        if (TXTR_IsIndexed(t)) {
+            for (c.palFmt = TXTR_TPF_IA8; c.palFmt <= TXTR_TPF_RGB5A3; c.palFmt++)
+                for (c.ditherType = GX_DT_MIN; c.ditherType <= GX_DT_MAX; c.ditherType++)
+                    cases[count++] = c;
+        } else if (t == TXTR_TTF_CMP) {
+            for (size_t f = 0; f < sizeof(fits) / sizeof(*fits); f++) {
+                c.squishFit = fits[f].flag;
+                c.squishFitName = fits[f].name;
+                cases[count++] = c;
+            }
+        } else
+            cases[count++] = c;
+    }
+    
+    *outCount = count;
+    return cases;
+}
+
+// mse is the decoded image's mean squared error per channel against its source, negative if op doesn't produce one
+static void printBenchResult(TTBenchOptions_t *opts, TTBenchCase_t *c, char *op, uint64_t *samples,
+size_t sampleCount, uint64_t pixels, uint64_t allocs, double mse, bool first) {
+    TTBenchStats_t st;
+    TTBench_Summarize(samples, sampleCount, &st);
+    double mpixps = st.total ? (double) pixels * 1000.0 / (double) st.total : 0.0;
+    double nspp = pixels ? (double) st.total / (double) pixels : 0.0;
+    double allocsPerCall = sampleCount ? (double) allocs / (double) sampleCount : 0.0;
+    
+    if (opts->json) {
+        sloprintf(opts->noOutp, "%s\n        {\"texture_format\": \"%s\", ", first ? "" : ",", Tex2Str(c->texFmt));
+        if (c->palFmt != TXTR_TPF_INVALID)
+            sloprintf(opts->noOutp, "\"palette_format\": \"%s\", \"dither_type\": \"%s\", ", Pal2Str(c->palFmt),
+                DitherType2Str(c->ditherType));
+        else
+            sloprintf(opts->noOutp, "\"palette_format\": null, \"dither_type\": null, ");
+        if (c->squishFitName)
+            sloprintf(opts->noOutp, "\"squish_fit\": \"%s\", ", c->squishFitName);
+        else
+            sloprintf(opts->noOutp, "\"squish_fit\": null, ");
+        sloprintf(opts->noOutp, "\"operation\": \"%s\", \"samples\": %zu, \"mpix_per_s\": %.3f, \"ns_per_pixel\": "
+            "%.3f, \"mean_ns\": %llu, \"p50_ns\": %llu, \"p99_ns\": %llu, ", op, sampleCount, mpixps, nspp,
+            (unsigned long long) st.mean, (unsigned long long) st.p50, (unsigned long long) st.p99);
+        if (mse >= 0.0)
+            sloprintf(opts->noOutp, "\"mse\": %.3f, ", mse);
+        else
+            sloprintf(opts->noOutp, "\"mse\": null, ");
+        if (TTBench_CountsAllocs())
+            sloprintf(opts->noOutp, "\"allocs_per_call\": %.1f}", allocsPerCall);
+        else
+            sloprintf(opts->noOutp, "\"allocs_per_call\": null}");
+    } else {
+        char variant[64];
+        if (c->palFmt != TXTR_TPF_INVALID)
+            snprintf(variant, sizeof(variant), "%s/%s", Pal2Str(c->palFmt), DitherType2Str(c->ditherType));
+        else
+            snprintf(variant, sizeof(variant), "%s", c->squishFitName ? c->squishFitName : "-");
+        sloprintf(opts->noOutp, "%-6s %-26s %-6s %9.2f MPix/s %9.2f ns/px  mean %10.3f ms  p50 %10.3f ms  p99 "
+            "%10.3f ms", Tex2Str(c->texFmt), variant, op, mpixps, nspp, (double) st.mean / 1e6,
+            (double) st.p50 / 1e6, (double) st.p99 / 1e6);
+        if (mse >= 0.0)
+            sloprintf(opts->noOutp, "  mse %9.3f", mse);
+        if (TTBench_CountsAllocs())
+            sloprintf(opts->noOutp, "  %8.1f allocs\n", allocsPerCall);
+        else
+            sloprintf(opts->noOutp, "\n");
+    }
+}
+
+// Checks the kernels of fmt against the baseline ones over every pixel value (see TTGX_Check)
+static TTStatus_t checkKernels(bool noErrp, TXTRFormat_t fmt) {
+    bool same = false;
+    int gce = TTGX_Check(fmt, &same);
+    if (gce) {
+        sleprintf(noErrp, "ERROR: Failed to check %s kernels: %s\n", Tex2Str(fmt), strerror(gce));
+        return gce == ENOMEM ? TTS_MEMERROR : TTS_PROGERROR;
+    } else if (!same) {
+        sleprintf(noErrp, "ERROR: %s decoded with the %s kernels differs from the baseline kernels\n", Tex2Str(fmt),
+            TTISA_ToStr(TTISA_Active()));
+        return TTS_PROGERROR;
+    }
+    return TTS_SUCCESS;
+}
+
+// Checks decodeDirect's kernels for fmt with checkKernels and then decodes the texture with both decodeDirect and
+// TXTR_Decode, failing if anything disagrees on any pixel
+static TTStatus_t checkDirectDecode(bool noErrp, TXTRFormat_t fmt, TXTR_t *txtr, size_t size, uint8_t *data) {
+    TTStatus_t cke = checkKernels(noErrp, fmt);
+    if (cke)
+        return cke;
+    
+    TXTRMipmap_t want[11];
+    TXTRMipmap_t got[11];
+    size_t wantCount = 0;
+    size_t gotCount = 0;
+    TXTRDecodeOptions_t decOpts = {
+        .flipX = false,
+        .flipY = false,
+        .decAllMips = true
+    };
+    TXTRDecodeError_t tde = TXTR_Decode(txtr, want, &wantCount, &decOpts);
+    if (tde) {
+        sleprintf(noErrp, "ERROR: Failed to decode %s: %s\n", Tex2Str(fmt), TXTRDecodeError_ToStr(tde));
+        return TTS_PROGERROR;
+    }
+    tde = decodeDirect(size, data, 0, 10, NULL, NULL, got, &gotCount);
+    if (tde) {
+        sleprintf(noErrp, "ERROR: Failed to decode %s: %s\n", Tex2Str(fmt), TXTRDecodeError_ToStr(tde));
+        for (size_t m = 0; m < wantCount; m++)
+            TXTRMipmap_free(&want[m]);
+        return TTS_PROGERROR;
+    }
+    
+    TTStatus_t status = TTS_SUCCESS;
+    for (size_t m = 0; m < wantCount && m < gotCount && !status; m++) {
+        if (want[m].width != got[m].width || want[m].height != got[m].height || want[m].size != got[m].size ||
+            memcmp(want[m].data, got[m].data, want[m].size)) {
+            sleprintf(noErrp, "ERROR: %s mipmap %zu decoded with the %s kernels differs from TXTR_Decode\n",
+                Tex2Str(fmt), m + 1, TTISA_ToStr(TTISA_Active()));
+            status = TTS_PROGERROR;
+        }
+    }
+    if (!status && wantCount != gotCount) {
+        sleprintf(noErrp, "ERROR: %s decoded with the %s kernels has %zu mipmaps instead of %zu\n", Tex2Str(fmt),
+            TTISA_ToStr(TTISA_Active()), gotCount, wantCount);
+        status = TTS_PROGERROR;
+    }
+    for (size_t m = 0; m < wantCount; m++)
+        TXTRMipmap_free(&want[m]);
+    for (size_t m = 0; m < gotCount; m++)
+        TXTRMipmap_free(&got[m]);
+    
+    return status;
+}
+
+// Mean squared error per channel between a decoded first mipmap and the source it was encoded from. Decoding gives rows
+// top to bottom while TGA data is bottom to top.
+static double mipError(TGA_t *tga, TXTRMipmap_t *mip) {
+    if (mip->width != tga->hdr.imageSpec.width || mip->height != tga->hdr.imageSpec.height)
+        return 0.0;
+    
+    uint64_t sum = 0;
+    size_t rowSz = (size_t) mip->width * 4;
+    for (size_t y = 0; y < mip->height; y++) {
+        uint8_t *got = &mip->data[y * rowSz];
+        uint8_t *want = &tga->data[(mip->height - 1 - y) * rowSz];
+        for (size_t i = 0; i < rowSz; i++)
+            sum += (uint64_t) ((got[i] - want[i]) * (got[i] - want[i]));
+    }
+    return (double) sum / (double) (rowSz * mip->height);
+}
+
+// Encodes every image with the case's settings iterations times and then decodes the result as many times, timing each
+// call on its own
+static TTStatus_t benchCase(TTBenchOptions_t *opts, TTEncodeOptions_t *encOpts, TTBenchCase_t *c, TGA_t *tgas,
+size_t tgaCount, uint64_t *encSamples, uint64_t *decSamples, bool first) {
+    TTEncodeOptions_t eo = *encOpts;
+    eo.texFmtDec = c->texFmt;
+    if (c->palFmt != TXTR_TPF_INVALID)
+        eo.palFmtDec = c->palFmt;
+    if (c->ditherType != GX_DT_INVALID)
+        eo.ditherTypeDec = c->ditherType;
+    eo.squishFlags = (eo.squishFlags & ~(kColourRangeFit | kColourClusterFit | kColourIterativeClusterFit)) |
+        c->squishFit;
+    eo.mipLimit = opts->mipLimit ? opts->mipLimit : 11;
+    if (TXTR_IsIndexed(c->texFmt))
+        eo.mipLimit = 1;
+    TXTREncodeOptions_t texOpts;
+    toTexEncodeOptions(&eo, &texOpts);
+    TXTRDecodeOptions_t decOpts = {
+        .flipX = false,
+        .flipY = TXTR_IsIndexed(c->texFmt),
+        .decAllMips = true
+    };
+    
+    size_t sampleCount = 0;
+    uint64_t pixels = 0, encAllocs = 0, decAllocs = 0;
+    double error = 0.0;
+    for (size_t i = 0; i < tgaCount && catexit_loopSafety; i++) {
+        TGA_t *tga = &tgas[i];
+        // --quantize works in place so every encode gets a fresh copy of the pixels, made before the clock starts
+        uint8_t *quantized = eo.quantize && TXTR_IsIndexed(c->texFmt) ? malloc(tga->dataSz) : NULL;
+        if (eo.quantize && TXTR_IsIndexed(c->texFmt) && !quantized) {
+            sleprintf(opts->noErrp, "ERROR: Failed to allocate memory for benchmark\n");
+            return TTS_MEMERROR;
+        }
+        // Encoded the way encodeTGA does so --threads and --concurrentmips are timed too
+        TGA_t src = *tga;
+        if (quantized)
+            src.data = quantized;
+        TXTR_t txtr;
+        TXTRRawMipmap_t txtrMips[11];
+        TXTR_t readTxtr;
+        bool haveRead = false;
+        // The written file kept for decodeDirect with --directdecode
+        size_t directSz = 0;
+        uint8_t *direct = NULL;
+        
+        for (uint16_t n = 0; n < opts->iterations && catexit_loopSafety; n++) {
+            if (quantized)
+                memcpy(quantized, tga->data, tga->dataSz);
+            TXTREncodeOptions_t iterOpts = texOpts;
+            uint64_t a = TTBench_Allocs();
+            uint64_t t = TTBench_Now();
+            TTStatus_t qpe = quantizePixels(&eo, &iterOpts, tga->hdr.imageSpec.width, tga->hdr.imageSpec.height,
+                quantized);
+            TXTREncodeError_t tee = qpe ? TXTR_EE_SUCCESS : encodeParallel(eo.texFmtDec, eo.palFmtDec, &src, &txtr,
+                txtrMips, &iterOpts, eo.concurrentMips, TTPool_ThreadCount(eo.threads, SIZE_MAX), NULL, eo.arena,
+                eo.resizeCache);
+            encSamples[sampleCount + n] = TTBench_Now() - t;
+            encAllocs += TTBench_Allocs() - a;
+            if (qpe || tee) {
+                if (tee)
+                    sleprintf(opts->noErrp, "ERROR: Failed to encode %s: %s\n", Tex2Str(c->texFmt),
+                        TXTREncodeError_ToStr(tee));
+                if (haveRead)
+                    TXTR_free(&readTxtr);
+                free(direct);
+                free(quantized);
+                return qpe ? qpe : TTS_PROGERROR;
+            }
+            
+            // Decoding needs a TXTR as it is read from a file so round trip the first encode through one
+            if (!haveRead) {
+                size_t txtrDataSz = 0;
+                uint8_t *txtrData = NULL;
+                TXTRWriteError_t twe = TXTR_Write(&txtr, txtrMips, &txtrDataSz, &txtrData);
+                TXTRReadError_t tre = twe ? TXTR_RE_INVLDPARAMS : TXTR_Read(&readTxtr, txtrDataSz, txtrData);
+                if (!twe && !tre && opts->directDecode && isDirectDecode(txtrDataSz, txtrData)) {
+                    directSz = txtrDataSz;
+                    direct = txtrData;
+                } else
+                    free(txtrData);
+                if (twe || tre) {
+                    sleprintf(opts->noErrp, "ERROR: Failed to round trip %s: %s\n", Tex2Str(c->texFmt),
+                        twe ? TXTRWriteError_ToStr(twe) : TXTRReadError_ToStr(tre));
+                    TXTR_free(&txtr);
+                    for (size_t m = 0; m < txtr.hdr.mipCount; m++)
+                        TXTRRawMipmap_free(&txtrMips[m]);
+                    free(quantized);
+                    return TTS_PROGERROR;
+                }
+                haveRead = true;
+            }
+            TXTR_free(&txtr);
+            for (size_t m = 0; m < txtr.hdr.mipCount; m++)
+                TXTRRawMipmap_free(&txtrMips[m]);
+        }
+        
+        // Timed the way decode does, so with --directdecode formats that aren't indexed go through the tool's own
+        // kernels, which are checked first, into an arena reset between iterations
+        TTStatus_t dce = haveRead && direct ? checkDirectDecode(opts->noErrp, c->texFmt, &readTxtr, directSz, direct) :
+            TTS_SUCCESS;
+        TTArena_t arena;
+        TTArena_Init(&arena, 0);
+        for (uint16_t n = 0; !dce && haveRead && n < opts->iterations && catexit_loopSafety; n++) {
+            TXTRMipmap_t mips[11];
+            size_t mipsCount = 0;
+            uint64_t a = TTBench_Allocs();
+            uint64_t t = TTBench_Now();
+            TXTRDecodeError_t tde = direct ? decodeDirect(directSz, direct, 0, 10, NULL, &arena, mips, &mipsCount) :
+                TXTR_Decode(&readTxtr, mips, &mipsCount, &decOpts);
+            decSamples[sampleCount + n] = TTBench_Now() - t;
+            decAllocs += TTBench_Allocs() - a;
+            if (tde) {
+                sleprintf(opts->noErrp, "ERROR: Failed to decode %s: %s\n", Tex2Str(c->texFmt),
+                    TXTRDecodeError_ToStr(tde));
+                dce = TTS_PROGERROR;
+                break;
+            }
+            if (!n && mipsCount)
+                error += mipError(tga, &mips[0]);
+            freeMips(mips, mipsCount, direct ? &arena : NULL);
+            TTArena_Reset(&arena);
+        }
+        TTArena_Free(&arena);
+        if (haveRead)
+            TXTR_free(&readTxtr);
+        free(direct);
+        free(quantized);
+        if (dce)
+            return dce;
+        
+        sampleCount += opts->iterations;
+        pixels += (uint64_t) tga->hdr.imageSpec.width * tga->hdr.imageSpec.height * opts->iterations;
+    }
+    if (!catexit_loopSafety)
+        return TTS_ERROR;
+    
+    printBenchResult(opts, c, "encode", encSamples, sampleCount, pixels, encAllocs, -1.0, first);
+    printBenchResult(opts, c, "decode", decSamples, sampleCount, pixels, decAllocs,
+        tgaCount ? error / (double) tgaCount : 0.0, false);
+    return TTS_SUCCESS;
+}
+
+static TTStatus_t bench(TTBenchOptions_t *opts, TTEncodeOptions_t *encOpts, int inputCount, char **inputs) {
+    TXTRFormat_t only = TXTR_TTF_INVALID;
+    if (opts->texFmt) {
+        only = Str2Tex(opts->texFmt);
+        if (only == TXTR_TTF_INVALID) {
+            sleprintf(opts->noErrp, "ERROR: --texfmt: Invalid format \"%s\". Valid values: " TexList(", ") "\n",
+                opts->texFmt);
+            return TTS_ARGERROR;
+        }
+    }
+    if (!opts->iterations) {
+        sleprintf(opts->noErrp, "ERROR: --iterations: Count must be greater than 0.\n");
+        return TTS_ARGERROR;
+    } else if (opts->mipLimit > 11) {
+        sleprintf(opts->noErrp, "ERROR: --miplimit: Limit %i must be less than 12.\n", opts->mipLimit);
+        return TTS_ARGERROR;
+    }
+    
+    if (opts->checkKernels) {
+        TTStatus_t status = TTS_SUCCESS;
+        for (TXTRFormat_t fmt = TXTR_TTF_I4; fmt <= TXTR_TTF_CMP && !status; fmt++) {
+            if (!TTGX_CanDecode(fmt) || (only != TXTR_TTF_INVALID && fmt != only))
+                continue;
+            status = checkKernels(opts->noErrp, fmt);
+            if (!status)
+                sloprintf(opts->noOutp, "%-6s %s kernels match the baseline\n", Tex2Str(fmt),
+                    TTISA_ToStr(TTISA_Active()));
+        }
+        return status;
+    }
+    
+    size_t caseCount = 0;
+    TTBenchCase_t *cases = listBenchCases(only, &caseCount);
+    TGA_t *tgas = calloc((size_t) inputCount, sizeof(TGA_t));
+    uint64_t *encSamples = malloc(sizeof(uint64_t) * (size_t) inputCount * opts->iterations);
+    uint64_t *decSamples = malloc(sizeof(uint64_t) * (size_t) inputCount * opts->iterations);
+    if (!cases || !tgas || !encSamples || !decSamples) {
+        sleprintf(opts->noErrp, "ERROR: Failed to allocate memory for benchmark\n");
+        free(cases);
+        free(tgas);
+        free(encSamples);
+        free(decSamples);
+        return TTS_MEMERROR;
+    }
+    
+    TTStatus_t status = TTS_SUCCESS;
+    int tgaCount = 0;
+    uint64_t pixels = 0;
+    for (; tgaCount < inputCount && !status; tgaCount++) {
+        status = readTGA(opts->noErrp, inputs[tgaCount], &tgas[tgaCount], NULL);
+        if (status)
+            break;
+        pixels += (uint64_t) tgas[tgaCount].hdr.imageSpec.width * tgas[tgaCount].hdr.imageSpec.height;
+    }
+    
+    if (!status) {
+        if (opts->json) {
+            sloprintf(opts->noOutp, "{\n    \"version\": \"%s\",\n    \"iterations\": %u,\n    \"mipmap_limit\": %u,\n"
+                "    \"allocs_counted\": %s,\n    \"pixels_per_iteration\": %llu,\n    \"images\": [", TT_VERSION,
+                opts->iterations, opts->mipLimit, TTBench_CountsAllocs() ? "true" : "false",
+                (unsigned long long) pixels);
+            for (int i = 0; i < inputCount; i++) {
+                sloprintf(opts->noOutp, "%s\"", i ? ", " : "");
+                printJSONString(opts->noOutp, inputs[i]);
+                sloprintf(opts->noOutp, "\"");
+            }
+            sloprintf(opts->noOutp, "],\n    \"results\": [");
+        } else
+            sloprintf(opts->noOutp, "Benchmarking %zu case%s over %i image%s (%llu pixels) with %u iteration%s "
+                "each...\n", caseCount, caseCount != 1 ? "s" : "", inputCount, inputCount != 1 ? "s" : "",
+                (unsigned long long) pixels, opts->iterations, opts->iterations != 1 ? "s" : "");
+        
+        for (size_t c = 0; c < caseCount && !status; c++)
+            status = benchCase(opts, encOpts, &cases[c], tgas, (size_t) inputCount, encSamples, decSamples, !c);
+        
+        if (opts->json)
+            sloprintf(opts->noOutp, "\n    ]\n}\n");
+    }
+    
+    for (int i = 0; i < tgaCount; i++)
+        TGA_free(&tgas[i]);
+    free(cases);
+    free(tgas);
+    free(encSamples);
+    free(decSamples);
+    return status;
+}
+#endif
+
+// Batch tasks
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+static void freeBatch(TTBatch_t *batch) {
+    for (size_t j = 0; j < batch->jobCount; j++) {
+        free(batch->jobs[j].input);
+        free(batch->jobs[j].output);
+    }
+    free(batch->jobs);
+    batch->jobs = NULL;
+    batch->jobCount = 0;
+}
+
+static TTStatus_t addBatchJob(bool noErrp, TTBatch_t *batch, size_t *capacity, char *input, char *output,
+bool outputIsDir) {
+    if (!input || !output) {
+        sleprintf(noErrp, "ERROR: Failed to allocate memory for batch job paths\n");
+        free(input);
+        free(output);
+        return TTS_MEMERROR;
+    }
+    
+    if (batch->jobCount == *capacity) {
+        size_t cap = *capacity ? *capacity * 2 : 64;
+        TTBatchJob_t *jobs = realloc(batch->jobs, sizeof(TTBatchJob_t) * cap);
+        if (!jobs) {
+            sleprintf(noErrp, "ERROR: Failed to allocate memory for batch jobs\n");
+            free(input);
+            free(output);
+            return TTS_MEMERROR;
+        }
+        batch->jobs = jobs;
+        *capacity = cap;
+    }
+    
+    // Create output directories up front so workers never have to ask about them
+    int mde = 0;
+    if (outputIsDir)
+        mde = TTFS_MkDirs(output);
+    else {
+        char *outputEnd = output + strlen(output);
+        while (outputEnd > output && outputEnd[-1] != '/' && outputEnd[-1] != '\\')
+            outputEnd--;
+        if (outputEnd > output + 1) {
+            char c = outputEnd[-1];
+            outputEnd[-1] = '\0';
+            mde = TTFS_MkDirs(output);
+            outputEnd[-1] = c;
+        }
+    }
+    if (mde) {
+        sleprintf(noErrp, "ERROR: Failed to create output directory for \"%s\": %s\n", output, strerror(mde));
+        free(input);
+        free(output);
+        return TTS_IOERROR;
+    }
+    
+    batch->jobs[batch->jobCount++] = (TTBatchJob_t) {
+        .input = input,
+        .output = output,
+        .status = TTS_ERROR
+    };
+    return TTS_SUCCESS;
+}
+
+// Fills batch with jobs from every inExt file under the input directory or from every line of the input manifest.
+// Manifest lines are "<input>" or "<input>\t<output>"; blank lines and lines starting with '#' are skipped. Outputs
+// not given are placed in output with the same relative path and the extension changed to outExt. If outExt is NULL
+// then every job's output is instead the directory the input's outputs go in.
+static TTStatus_t collectBatchJobs(bool noErrp, bool yes, bool no, bool noOutp, char *input, char *output, char *inExt,
+char *outExt, TTBatch_t *batch) {
+    bool inputIsDir = false;
+    if (cfexists(input, &inputIsDir)) {
+        sleprintf(noErrp, "ERROR: Input directory or manifest \"%s\" does not exist\n", input);
+        return TTS_IOERROR;
+    }
+    
+    bool outputIsDir = false;
+    bool outputExists = !cfexists(output, &outputIsDir);
+    if (outputExists && !outputIsDir) {
+        sleprintf(noErrp, "ERROR: Output directory \"%s\" must be a directory\n", output);
+        return TTS_PROGERROR;
+    } else if (!outputExists) {
+        sloprintf(no || yes || noOutp, "Output directory \"%s\" does not exist. Create it? (y,Y/ANY) ", output);
+        if (no || askYN(yes, noOutp)) {
+            sleprintf(noErrp, "ERROR: Not creating output directory \"%s\"\n", output);
+            return TTS_PROGERROR;
+        }
+    }
+    
+    batch->jobs = NULL;
+    batch->jobCount = 0;
+    size_t capacity = 0;
+    if (inputIsDir) {
+        char **paths = NULL;
+        size_t pathCount = 0;
+        int lfe = TTFS_ListFiles(input, inExt, &paths, &pathCount);
+        if (lfe) {
+            sleprintf(noErrp, "ERROR: Failed to list input directory \"%s\": %s\n", input, strerror(lfe));
+            return lfe == ENOMEM ? TTS_MEMERROR : TTS_IOERROR;
+        }
+        
+        for (size_t i = 0; i < pathCount; i++) {
+            char *jobOutput = NULL;
+            if (outExt) {
+                char *outRel = TTFS_ReplaceExt(paths[i], outExt);
+                jobOutput = outRel ? TTFS_Join(output, outRel) : NULL;
+                free(outRel);
+            } else {
+                char *relEnd = strrchr(paths[i], '/');
+                if (relEnd) {
+                    *relEnd = '\0';
+                    jobOutput = TTFS_Join(output, paths[i]);
+                    *relEnd = '/';
+                } else
+                    jobOutput = csprintf_s("%s", output);
+            }
+            
+            TTStatus_t aje = addBatchJob(noErrp, batch, &capacity, TTFS_Join(input, paths[i]), jobOutput, !outExt);
+            if (aje) {
+                TTFS_FreeList(paths, pathCount);
+                freeBatch(batch);
+                return aje;
+            }
+        }
+        TTFS_FreeList(paths, pathCount);
+    } else {
+        uint8_t *manData = NULL;
+        size_t manDataSz = 0;
+        TTStatus_t rfe = readFile(noErrp, input, &manDataSz, &manData);
+        if (rfe)
+            return rfe;
+        
+        char *man = realloc(manData, manDataSz + 1);
+        if (!man) {
+            sleprintf(noErrp, "ERROR: Failed to allocate memory for manifest data\n");
+            free(manData);
+            return TTS_MEMERROR;
+        }
+        man[manDataSz] = '\0';
+        
+        for (char *line = man, *next; line; line = next) {
+            next = strchr(line, '\n');
+            if (next)
+                *next++ = '\0';
+            
+            size_t len = strlen(line);
+            if (len && line[len - 1] == '\r')
+                line[--len] = '\0';
+            if (!len || line[0] == '#')
+                continue;
+            
+            char *lineOutput = strchr(line, '\t');
+            if (lineOutput)
+                *lineOutput++ = '\0';
+            
+            char *jobOutput = NULL;
+            if (lineOutput && *lineOutput)
+                jobOutput = csprintf_s("%s", lineOutput);
+            else if (!outExt)
+                jobOutput = csprintf_s("%s", output);
+            else {
+                char *name = line + strlen(line);
+                while (name > line && name[-1] != '/' && name[-1] != '\\')
+                    name--;
+                char *outName = TTFS_ReplaceExt(name, outExt);
+                jobOutput = outName ? TTFS_Join(output, outName) : NULL;
+                free(outName);
+            }
+            
+            TTStatus_t aje = addBatchJob(noErrp, batch, &capacity, csprintf_s("%s", line), jobOutput, !outExt);
+            if (aje) {
+                free(man);
+                freeBatch(batch);
+                return aje;
+            }
+        }
+        free(man);
+    }
+    
+    if (!batch->jobCount) {
+        sleprintf(noErrp, "ERROR: No input files found in \"%s\"\n", input);
+        return TTS_ARGERROR;
+    }
+    
+    return TTS_SUCCESS;
+}
+
+// Runs every job of the batch on the worker pool and folds the per-file statuses into one: success if every file
+// succeeded, the shared status if every failure failed the same way, otherwise TTS_ERROR.
+static TTStatus_t runBatch(TTBatchOptions_t *bopts, bool noOutp, bool noErrp, TTBatch_t *batch, TTPoolJob_t job,
+char *verb) {
+    size_t threads = TTPool_ThreadCount(bopts->jobs, batch->jobCount);
+    sloprintf(noOutp, "Processing %zu file%s on %zu thread%s...\n", batch->jobCount,
+        batch->jobCount != 1 ? "s" : "", threads, threads != 1 ? "s" : "");
+    
+    // Every worker gets an arena of its own that is reset between its files, without them files go to the heap
+    batch->arenas = malloc(threads * sizeof(*batch->arenas));
+    if (batch->arenas)
+        for (size_t t = 0; t < threads; t++)
+            TTArena_Init(&batch->arenas[t], 0);
+    // Every worker also gets a resize cache so files of the same size only build each level's samplers once. Only
+    // encodes with --concurrentmips resize here (see encodeParallel), for the rest the caches stay empty
+    batch->resizeCaches = malloc(threads * sizeof(*batch->resizeCaches));
+    if (batch->resizeCaches)
+        for (size_t t = 0; t < threads; t++)
+            TTResizeCache_Init(&batch->resizeCaches[t]);
+    
+    TTPool_Run(threads, batch->jobCount, job, batch);
+    
+    if (batch->resizeCaches) {
+        uint64_t resizes = 0, hits = 0;
+        for (size_t t = 0; t < threads; t++) {
+            resizes += batch->resizeCaches[t].clock;
+            hits += batch->resizeCaches[t].hits;
+            TTResizeCache_Free(&batch->resizeCaches[t]);
+        }
+        free(batch->resizeCaches);
+        batch->resizeCaches = NULL;
+        if (resizes)
+            sloprintf(noOutp, "Resize: %llu of %llu mipmap resize%s reused built samplers\n",
+                (unsigned long long) hits, (unsigned long long) resizes, resizes != 1 ? "s" : "");
+    }
+    
+    if (batch->arenas) {
+        TTArena_t total = { .allocs = 0, .heapAllocs = 0, .peak = 0 };
+        for (size_t t = 0; t < threads; t++) {
+            total.allocs += batch->arenas[t].allocs;
+            total.heapAllocs += batch->arenas[t].heapAllocs;
+            if (batch->arenas[t].peak > total.peak)
+                total.peak = batch->arenas[t].peak;
+            TTArena_Free(&batch->arenas[t]);
+        }
+        free(batch->arenas);
+        batch->arenas = NULL;
+        sloprintf(noOutp, "Scratch: %llu allocation%s served from %llu heap block%s (%zu KiB peak per worker)\n",
+            (unsigned long long) total.allocs, total.allocs != 1 ? "s" : "", (unsigned long long) total.heapAllocs,
+            total.heapAllocs != 1 ? "s" : "", (total.peak + 1023) >> 10);
+    }
+    
+    TTStatus_t status = TTS_SUCCESS;
+    size_t failed = 0;
+    for (size_t j = 0; j < batch->jobCount; j++) {
+        TTStatus_t js = batch->jobs[j].status;
+        if (!js)
+            continue;
+        
+        sleprintf(noErrp, "ERROR: Failed on \"%s\": %s\n", batch->jobs[j].input, Status2Str(js));
+        if (!failed++)
+            status = js;
+        else if (status != js)
+            status = TTS_ERROR;
+    }
+    
+    sloprintf(noOutp, "Batch %s %zu of %zu file%s successfully\n", verb, batch->jobCount - failed, batch->jobCount,
+        batch->jobCount != 1 ? "s" : "");
+    
+    return status;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+static void batchEncodeJob(void *ctx, size_t job, size_t worker) {
+    TTBatch_t *batch = ctx;
+    TTEncodeOptions_t opts = *(TTEncodeOptions_t *) batch->opts;
+    opts.arena = batch->arenas ? &batch->arenas[worker] : NULL;
+    opts.resizeCache = batch->resizeCaches ? &batch->resizeCaches[worker] : NULL;
+    
+    batch->jobs[job].status = encode(&opts, batch->jobs[job].input, batch->jobs[job].output);
+    if (opts.arena)
+        TTArena_Reset(opts.arena);
+}
+
+static TTStatus_t batchEncode(TTBatchOptions_t *bopts, TTEncodeOptions_t *opts, char *input, char *output) {
+    // Workers cannot share the terminal for prompts so anything that would be asked is answered up front
+    TTEncodeOptions_t jobOpts = *opts;
+    jobOpts.no = !jobOpts.yes;
+    // Files are already encoded in parallel so unless asked for do not have every file go wide on top of that
+    if (!jobOpts.threads)
+        jobOpts.threads = 1;
+    
+    TTBatch_t batch = { .opts = &jobOpts, .budget = NULL, .arenas = NULL, .resizeCaches = NULL };
+    TTStatus_t cje = collectBatchJobs(opts->noErrp, opts->yes, opts->no, opts->noOutp, input, output, ".tga",
+        ".TXTR", &batch);
+    if (cje)
+        return cje;
+    
+    TTStatus_t status = runBatch(bopts, opts->noOutp, opts->noErrp, &batch, batchEncodeJob, "encoded");
+    freeBatch(&batch);
+    
+    return status;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_DECODE
+// Rough peak memory of decoding a TXTR judged from its header alone: every decoded mipmap and the serialized TGA of the
+// largest one, plus TXTR_Read's copy of the file unless the tool's kernels decode straight from the mapping (only with
+// allowDirect). Returns 0 if the header can't be read (the decode itself will report why).
+static size_t estimateDecodeMemory(char *input, uint8_t firstMip, uint8_t lastMip, bool allowDirect) {
+    TTInfo_t info;
+    if (TTInfo_Read(&info, input))
+        return 0;
+    
+    size_t width = info.hdr.width;
+    size_t height = info.hdr.height;
+    uint32_t mipCount = info.hdr.mipCount;
+    if (!mipCount)
+        mipCount = 1;
+    else if (mipCount > 11)
+        mipCount = 11;
+    if (mipCount > lastMip + 1u)
+        mipCount = lastMip + 1u;
+    for (uint32_t m = 0; m < firstMip && m + 1 < mipCount; m++) {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    
+    size_t est = (allowDirect && isDirectInfo(&info, info.fileSz) ? 0 : info.fileSz) + width * height * 4;
+    for (uint32_t m = firstMip; m < mipCount; m++) {
+        est += width * height * 4;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return est;
+}
+
+static void batchDecodeJob(void *ctx, size_t job, size_t worker) {
+    TTBatch_t *batch = ctx;
+    TTDecodeOptions_t opts = *(TTDecodeOptions_t *) batch->opts;
+    opts.arena = batch->arenas ? &batch->arenas[worker] : NULL;
+    
+    size_t reserved = batch->budget ? TTBudget_Acquire(batch->budget,
+        estimateDecodeMemory(batch->jobs[job].input, opts.firstMip, opts.lastMip, opts.directDecode)) : 0;
+    batch->jobs[job].status = decode(&opts, batch->jobs[job].input, batch->jobs[job].output);
+    // Memory kept in the arena after the job would no longer be covered by the budget so it goes back with it
+    if (opts.arena) {
+        if (batch->budget)
+            TTArena_Free(opts.arena);
+        else
+            TTArena_Reset(opts.arena);
+    }
+    TTBudget_Release(batch->budget, reserved);
+}
+
+static TTStatus_t batchDecode(TTBatchOptions_t *bopts, TTDecodeOptions_t *opts, char *input, char *output) {
+    // Workers cannot share the terminal for prompts so anything that would be asked is answered up front
+    TTDecodeOptions_t jobOpts = *opts;
+    jobOpts.no = !jobOpts.yes;
+    
+    TTBudget_t budget;
+    TTBatch_t batch = { .opts = &jobOpts, .budget = NULL, .arenas = NULL, .resizeCaches = NULL };
+    if (bopts->memBudget) {
+        if (!TTBudget_Init(&budget, (size_t) bopts->memBudget << 20)) {
+            sleprintf(opts->noErrp, "ERROR: Failed to set up memory budget\n");
+            return TTS_PROGERROR;
+        }
+        batch.budget = &budget;
+    }
+    
+    TTStatus_t cje = collectBatchJobs(opts->noErrp, opts->yes, opts->no, opts->noOutp, input, output, ".txtr",
+        opts->mipmaps ? NULL : opts->formatDec == TTDF_DDS ? ".dds" : ".tga", &batch);
+    if (cje) {
+        if (batch.budget)
+            TTBudget_Free(batch.budget);
+        return cje;
+    }
+    
+    TTStatus_t status = runBatch(bopts, opts->noOutp, opts->noErrp, &batch, batchDecodeJob, "decoded");
+    freeBatch(&batch);
+    if (batch.budget)
+        TTBudget_Free(batch.budget);
+    
+    return status;
+}
+#endif
+
+// optparse99 tasks
+static void printHelp(int argc, char **argv) {
+    optparse_print_help_subcmd_noexit(argc, argv);
+    exit(TTS_SUCCESS);
+}
+
+// Picks the instruction set kernels run with: the best one the CPU supports unless --isa says otherwise
+static TTStatus_t selectISA(void) {
+    TTISA_t isa = ttISA ? TTISA_FromStr(ttISA) : TTISA_Detect();
+    if (isa == TTISA_INVALID) {
+        eprintf("ERROR: --isa: Invalid instruction set \"%s\". Valid values: " ISAList(", ") "\n", ttISA);
+        return TTS_ERROR;
+    } else if (!TTISA_Select(isa)) {
+        eprintf("ERROR: --isa: Instruction set \"%s\" is not supported by this CPU or build.\n", ttISA);
+        return TTS_ERROR;
+    }
+    return TTS_SUCCESS;
+}
+
+static void printVersion(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    TTStatus_t sie = selectISA();
+    if (sie)
+        exit(sie);
+    oprintf("%s\n", TT_TITLE);
+    oprintf("Kernels: %s (best supported: %s)\n", TTISA_ToStr(TTISA_Active()), TTISA_ToStr(TTISA_Detect()));
+    exit(TTS_SUCCESS);
+}
+
+#ifdef TXTRTOOL_INCLUDE_DECODE
+static void setDecodeMode(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    ttMode = TTM_DECODE;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+static void setEncodeMode(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    ttMode = TTM_ENCODE;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+static void setBatchEncodeMode(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    ttMode = TTM_BATCHENCODE;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_DECODE
+static void setBatchDecodeMode(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    ttMode = TTM_BATCHDECODE;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_DECODE
+static void setThumbMode(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    ttMode = TTM_THUMB;
+}
+#endif
+
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+static void setServeMode(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    ttMode = TTM_SERVE;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_MISC
+static void setPrintMode(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    ttMode = TTM_PRINT;
+}
+#endif
+
+#if defined(TXTRTOOL_INCLUDE_ENCODE) && defined(TXTRTOOL_INCLUDE_MISC)
+static void setBenchMode(int argc, char **argv) {
+    FAKEREF(argc);
+    FAKEREF(argv);
+    ttMode = TTM_BENCH;
+}
+#endif
+
+// Argument validation tasks
+#ifdef TXTRTOOL_INCLUDE_DECODE
+static TTStatus_t validateDecodeOptions(TTDecodeOptions_t *opts) {
+    opts->formatDec = Str2DecFmt(opts->format);
+    if (opts->formatDec == TTDF_INVALID) {
+        eprintf("ERROR: --format: Invalid output format \"%s\". Valid values: " DecFmtList(", ") "\n", opts->format);
+        return TTS_ERROR;
+    } else if (opts->formatDec == TTDF_DDS && opts->mipmaps) {
+        eprintf("ERROR: --format: A DDS already holds every mipmap in one file; use --mips to pick them.\n");
+        return TTS_ERROR;
+    } else if (opts->formatDec == TTDF_DDS && opts->rect) {
+        eprintf("ERROR: --format: A rectangle cannot be written as DDS.\n");
+        return TTS_ERROR;
+    }
+    
+    if (opts->mip && opts->mipRange) {
+        eprintf("ERROR: --mip and --mips cannot be used together.\n");
+        return TTS_ERROR;
+    }
+    
+    if (opts->mip) {
+        if (opts->mip > 11) {
+            eprintf("ERROR: --mip: Mipmap %u must be less than 12.\n", opts->mip);
+            return TTS_ERROR;
+        } else if (opts->mipmaps) {
+            eprintf("ERROR: --mip: A single mipmap cannot be output to a directory; use --mips instead.\n");
+            return TTS_ERROR;
+        }
+        opts->firstMip = opts->lastMip = (uint8_t) (opts->mip - 1);
+    } else if (opts->mipRange) {
+        // Either "A" or "A-B", both 1 based like the mipmap file names
+        char *end;
+        unsigned long first = strtoul(opts->mipRange, &end, 10);
+        unsigned long last = first;
+        if (end != opts->mipRange && *end == '-') {
+            char *lastStr = end + 1;
+            last = strtoul(lastStr, &end, 10);
+            if (end == lastStr)
+                end = opts->mipRange;
+        }
+        if (end == opts->mipRange || *end || !first || first > last || last > 11) {
+            eprintf("ERROR: --mips: Invalid range \"%s\". Must be A or A-B where 1 <= A <= B <= 11.\n",
+                opts->mipRange);
+            return TTS_ERROR;
+        }
+        opts->mipmaps = opts->formatDec != TTDF_DDS;
+        opts->firstMip = (uint8_t) (first - 1);
+        opts->lastMip = (uint8_t) (last - 1);
+    } else {
+        opts->firstMip = 0;
+        opts->lastMip = opts->mipmaps || opts->formatDec == TTDF_DDS ? 10 : 0;
+    }
+    
+    if (opts->rect) {
+        unsigned int rect[4];
+        int end = 0;
+        if (sscanf(opts->rect, "%u,%u,%u,%u%n", &rect[0], &rect[1], &rect[2], &rect[3], &end) != 4 ||
+            opts->rect[end] || rect[0] > UINT16_MAX || rect[1] > UINT16_MAX || !rect[2] || rect[2] > UINT16_MAX ||
+            !rect[3] || rect[3] > UINT16_MAX) {
+            eprintf("ERROR: --rect: Invalid rectangle \"%s\". Must be x,y,w,h with w and h greater than 0.\n",
+                opts->rect);
+            return TTS_ERROR;
+        } else if (opts->firstMip != opts->lastMip) {
+            eprintf("ERROR: --rect: Only a single mipmap can be decoded; use --mip to pick it.\n");
+            return TTS_ERROR;
+        }
+        opts->rectDec = (TTRect_t) {
+            .x = (uint16_t) rect[0],
+            .y = (uint16_t) rect[1],
+            .width = (uint16_t) rect[2],
+            .height = (uint16_t) rect[3]
+        };
     }
     
-    sloprintf(opts->noOutp, "Reading input TGA \"%s\"...\n", input);
+    return TTS_SUCCESS;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+static TTStatus_t validateEncodeOptions(TTEncodeOptions_t *opts) {
+    opts->texFmtDec = Str2Tex(opts->texFmt);
+    if (opts->texFmtDec == TXTR_TTF_INVALID) {
+        eprintf("ERROR: --texfmt: Invalid format \"%s\". Valid values: " TexList(", ") "\n", opts->texFmt);
+        return TTS_ERROR;
+    }
     
-    TGA_t tga;
-    TTStatus_t tre = readTGA(opts->noErrp, input, &tga);
-    if (tre)
-        return tre;
+    opts->palFmtDec = Str2Pal(opts->palFmt);
+    if (opts->palFmtDec == TXTR_TPF_INVALID) {
+        eprintf("ERROR: --palfmt: Invalid format \"%s\". Valid values: " PalList(", ") "\n", opts->palFmt);
+        return TTS_ERROR;
+    }
     
-    sloprintf(opts->noOutp, "Encoding TXTR...\n");
+    if (opts->mipLimit > 11) {
+        eprintf("ERROR: --miplimit: Limit %i must be less than 12.\n", opts->mipLimit);
+        return TTS_ERROR;
+    } else if (TXTR_IsIndexed(opts->texFmtDec) && opts->mipLimit > 1) {
+        eprintf("ERROR: --miplimit: Limit %i must be either 1 or 0 on indexed formats.\n", opts->mipLimit);
+        return TTS_ERROR;
+    }
+    if (!opts->mipLimit)
+        opts->mipLimit = !TXTR_IsIndexed(opts->texFmtDec) ? 11 : 1;
     
-    TXTR_t txtr;
-    TXTRRawMipmap_t txtrMips[11];
-    TXTREncodeOptions_t texOpts = {
-        .flipX = false,
-        .flipY = !TXTR_IsIndexed(opts->texFmtDec),
-        .mipLimit = opts->mipLimit,
-        .widthLimit = opts->widthLimit,
-        .heightLimit = opts->heightLimit,
-        .avgType = opts->avgTypeDec,
-        .squishFlags = opts->squishFlags,
-        .squishMetricSz = opts->squishMetricSz,
-        .squishMetric = opts->squishMetricPtr,
-        .stbirEdge = opts->stbirEdgeDec,
-        .stbirFilter = opts->stbirFilterDec,
-        .ditherType = opts->ditherTypeDec
-    };
-    TXTREncodeError_t tee = TXTR_Encode(opts->texFmtDec, opts->palFmtDec, tga.hdr.imageSpec.width,
-        tga.hdr.imageSpec.height, tga.dataSz, tga.data, &txtr, txtrMips, &texOpts);
-    if (tee) {
-        sleprintf(opts->noErrp, "ERROR: Failed to encode TXTR data: %s\n", TXTREncodeError_ToStr(tee));
-        TGA_free(&tga);
-        
-        switch (tee) {
-            case TXTR_EE_MEMFAILSRCPXS:
-            case TXTR_EE_MEMFAILMIP:
-            case TXTR_EE_MEMFAILPAL:
-                return TTS_MEMERROR;
-            case TXTR_EE_INVLDPARAMS:
-            case TXTR_EE_INVLDTEXFMT:
-            case TXTR_EE_INVLDPALFMT:
-            case TXTR_EE_INVLDTEXWIDTH:
-            case TXTR_EE_INVLDTEXHEIGHT:
-            case TXTR_EE_INVLDTEXMIPLMT:
-            case TXTR_EE_INVLDTEXWIDTHLMT:
-            case TXTR_EE_INVLDTEXHEIGHTLMT:
-            case TXTR_EE_INVLDGXAVGTYPE:
-            case TXTR_EE_TRYMIPPALFMT:
-            case TXTR_EE_INVLDSTBIREDGEMODE:
-            case TXTR_EE_INVLDSTBIRFILTER:
-            case TXTR_EE_INVLDSQUISHMETRICSZ:
-            case TXTR_EE_INVLDGXDITHERTYPE:
-                return TTS_ARGERROR;
-            case TXTR_EE_FAILBUILDPAL:
-            case TXTR_EE_RESIZEFAIL:
-            case TXTR_EE_INTERRUPTED:
-            case TXTR_EE_FAILENCPAL:
-            default:
-                return TTS_PROGERROR;
-        }
+    if (!opts->widthLimit) {
+        eprintf("ERROR: --widthlimit: Limit %u must be greater than 0.\n", opts->widthLimit);
+        return TTS_ERROR;
     }
-    TGA_free(&tga);
+    // There is no way to check if its greater than image width at this point
     
-    sloprintf(opts->noOutp, "Writing %u mipmap%s to output TXTR \"%s\"...\n", txtr.hdr.mipCount,
-        txtr.hdr.mipCount != 1 ? "s" : "", output);
+    if (!opts->heightLimit) {
+        eprintf("ERROR: --heightlimit: Limit %u must be greater than 0.\n", opts->heightLimit);
+        return TTS_ERROR;
+    }
+    // There is no way to check if its greater than image height at this point
     
-    TTStatus_t twe = writeTXTR(opts->noOutp, opts->noErrp, opts->yes, opts->no, output, &txtr, txtrMips);
-    if (twe) {
-        TXTR_free(&txtr);
-        for (size_t m = 0; m < txtr.hdr.mipCount; m++)
-            TXTRRawMipmap_free(&txtrMips[m]);
-        return twe;
+    opts->avgTypeDec = Str2AvgTyp(opts->avgType);
+    if (opts->avgTypeDec == GX_AT_INVALID) {
+        eprintf("ERROR: --avgtype: Invalid average type \"%s\". Valid values: " AvgTypList(", ") "\n",
+            opts->avgType);
+        return TTS_ERROR;
     }
-    TXTR_free(&txtr);
-    for (size_t m = 0; m < txtr.hdr.mipCount; m++)
-        TXTRRawMipmap_free(&txtrMips[m]);
+    
+    opts->stbirEdgeDec = Str2Edge(opts->stbirEdge);
+    if (opts->stbirEdgeDec < STBIR_EDGE_CLAMP || opts->stbirEdgeDec > STBIR_EDGE_ZERO) {
+        eprintf("ERROR: --stbiredge: Invalid edge mode \"%s\". Valid values: " EdgeList(", ") "\n",
+            opts->stbirEdge);
+        return TTS_ERROR;
+    }
+    
+    opts->stbirFilterDec = Str2Filter(opts->stbirFilter);
+    if (opts->stbirFilterDec < STBIR_FILTER_DEFAULT || opts->stbirFilterDec > STBIR_FILTER_POINT_SAMPLE) {
+        eprintf("ERROR: --stbirfilter: Invalid filter mode \"%s\". Valid values: " FilterList(", ") "\n",
+            opts->stbirFilter);
+        return TTS_ERROR;
+    }
+    
+    // Left NULL unless given so a colour mapped input can tell it was asked for (see encodeTGA)
+    opts->ditherTypeDec = opts->ditherType ? Str2DitherType(opts->ditherType) : GX_DT_THRESHOLD;
+    if (opts->ditherTypeDec == GX_DT_INVALID) {
+        eprintf("ERROR: --dithertype: Invalid dither type \"%s\". Valid values: " DitherTypeList(", ") "\n",
+            opts->ditherType);
+        return TTS_ERROR;
+    }
+    
+    if (opts->squishMetricValid) {
+        if (opts->squishMetricSz != 3) {
+            eprintf("ERROR: --squishmetric: Metric of size %zu must be 3.\n", opts->squishMetricSz);
+            return TTS_ERROR;
+        } else {
+            if (opts->squishMetricPtr[0] < 0.0f || opts->squishMetricPtr[0] > 1.0f) {
+                eprintf("ERROR: --squishmetric: Metric's first component must be between 0.0 and 1.0.\n");
+                return TTS_ERROR;
+            }
+            
+            if (opts->squishMetricPtr[1] < 0.0f || opts->squishMetricPtr[1] > 1.0f) {
+                eprintf("ERROR: --squishmetric: Metric's second component must be between 0.0 and 1.0.\n");
+                return TTS_ERROR;
+            }
+            
+            if (opts->squishMetricPtr[2] < 0.0f || opts->squishMetricPtr[2] > 1.0f) {
+                eprintf("ERROR: --squishmetric: Metric's third component must be between 0.0 and 1.0.\n");
+                return TTS_ERROR;
+            }
+        }
+    }
+    
+    if (!!opts->squishAlphaWeight)
+        opts->squishFlags |= kWeightColourByAlpha;
+    if (!!opts->squishClusterFit)
+        opts->squishFlags |= kColourClusterFit;
+    if (!!opts->squishRangeFit)
+        opts->squishFlags |= kColourRangeFit;
+    if (!!opts->squishIterClusterFit)
+        opts->squishFlags |= kColourIterativeClusterFit;
     
     return TTS_SUCCESS;
 }
 #endif
 
-#ifdef TXTRTOOL_INCLUDE_MISC
-static TTStatus_t print(TTPrintOptions_t *opts, char *input) {
-    sleprintf(opts->noErrp, "Reading input TXTR \"%s\"...\n", input);
-    
-    TXTR_t txtr;
-    TTStatus_t tre = readTXTR(opts->noErrp, input, &txtr);
-    if (tre)
-        return tre;
+// Option field tasks
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+#define TTOF(opts, type, name, longName) { TOSTR(name), longName, type, offsetof(opts, name) }
+
+#ifdef TXTRTOOL_INCLUDE_DECODE
+static const TTOptionField_t decodeOptionFields[] = {
+    TTOF(TTDecodeOptions_t, TTOF_FLAG, yes, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_FLAG, mipmaps, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_UINT8, mip, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_STR, mipRange, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_STR, rect, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_STR, prefix, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_STR, suffix, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_STR, format, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_FLAG, legacyOrigin, NULL),
+    TTOF(TTDecodeOptions_t, TTOF_FLAG, directDecode, NULL)
+};
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+// squishMetric is a list so it is handled on its own. Prompts and threads are for the whole command, not a target.
+static const TTOptionField_t encodeOptionFields[] = {
+    TTOF(TTEncodeOptions_t, TTOF_FLAG, yes, NULL),
+    TTOF(TTEncodeOptions_t, TTOF_STR, texFmt, "texfmt"),
+    TTOF(TTEncodeOptions_t, TTOF_STR, palFmt, "palfmt"),
+    TTOF(TTEncodeOptions_t, TTOF_UINT8, mipLimit, "miplimit"),
+    TTOF(TTEncodeOptions_t, TTOF_UINT16, widthLimit, "widthlimit"),
+    TTOF(TTEncodeOptions_t, TTOF_UINT16, heightLimit, "heightlimit"),
+    TTOF(TTEncodeOptions_t, TTOF_STR, avgType, "avgtype"),
+    TTOF(TTEncodeOptions_t, TTOF_STR, stbirEdge, "stbiredge"),
+    TTOF(TTEncodeOptions_t, TTOF_STR, stbirFilter, "stbirfilter"),
+    TTOF(TTEncodeOptions_t, TTOF_STR, ditherType, "dithertype"),
+    TTOF(TTEncodeOptions_t, TTOF_FLAG, squishAlphaWeight, "squishalphaweight"),
+    TTOF(TTEncodeOptions_t, TTOF_FLAG, squishClusterFit, "squishclusterfit"),
+    TTOF(TTEncodeOptions_t, TTOF_FLAG, squishRangeFit, "squishrangefit"),
+    TTOF(TTEncodeOptions_t, TTOF_FLAG, squishIterClusterFit, "squishiterclusterfit"),
+    TTOF(TTEncodeOptions_t, TTOF_FLAG, concurrentMips, "concurrentmips"),
+    TTOF(TTEncodeOptions_t, TTOF_FLAG, quantize, "quantize"),
+    TTOF(TTEncodeOptions_t, TTOF_FLAG, legacyOrigin, "legacyorigin"),
+    TTOF(TTEncodeOptions_t, TTOF_UINT16, threads, NULL)
+};
+#endif
+
+static char *optionFieldTypeNames[] = {
+    [TTOF_FLAG] = "a boolean",
+    [TTOF_STR] = "a string",
+    [TTOF_UINT8] = "an integer from 0 to 255",
+    [TTOF_UINT16] = "an integer from 0 to 65535"
+};
+
+// Sets the option f in opts from its text: true or false for flags and a decimal number for integers. Returns false
+// if value isn't one.
+static bool setOptionField(const TTOptionField_t *f, void *opts, char *value) {
+    uint8_t *at = (uint8_t *) opts + f->offset;
+    switch (f->type) {
+        case TTOF_FLAG:
+            if (strcmp(value, "true") && strcmp(value, "false"))
+                return false;
+            *(int *) at = value[0] == 't';
+            return true;
+        case TTOF_STR:
+            *(char **) at = value;
+            return true;
+        case TTOF_UINT8:
+        case TTOF_UINT16: {
+            char *end;
+            unsigned long v = strtoul(value, &end, 10);
+            unsigned long max = f->type == TTOF_UINT8 ? UINT8_MAX : UINT16_MAX;
+            if (!*value || *end || value[0] == '-' || v > max)
+                return false;
+            if (f->type == TTOF_UINT8)
+                *at = (uint8_t) v;
+            else
+                *(uint16_t *) at = (uint16_t) v;
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+static const TTOptionField_t *findTargetField(char *name, size_t nameLen) {
+    for (size_t i = 0; i < sizeof(encodeOptionFields) / sizeof(*encodeOptionFields); i++) {
+        char *longName = encodeOptionFields[i].longName;
+        if (longName && strlen(longName) == nameLen && !strncmp(name, longName, nameLen))
+            return &encodeOptionFields[i];
+    }
+    return NULL;
+}
+
+// Splits encode's operands after the input into targets. Every operand is an output unless it is <option>=<value> with
+// the long name of an option a target can set, which then overrides that option for the output before it. Targets
+// start from opts as parsed (before validateEncodeOptions) and are validated here.
+static TTStatus_t parseEncodeTargets(TTEncodeOptions_t *opts, int argc, char **argv, TTEncodeTarget_t **outTargets,
+size_t *outCount) {
+    TTEncodeTarget_t *targets = malloc(sizeof(TTEncodeTarget_t) * (size_t) argc);
+    if (!targets) {
+        eprintf("ERROR: Failed to allocate memory for encode targets\n");
+        return TTS_MEMERROR;
+    }
     
-    if (opts->json) {
-        sloprintf(opts->noOutp,
-            "{\n"
-            "    \"texture_format\": \"%s\",\n"
-            "    \"texture_width\": %u,\n"
-            "    \"texture_height\": %u,\n"
-            "    \"texture_mipmap_count\": %u,\n"
-            "    \"palette_format\": \"%s\",\n"
-            "    \"palette_width\": %u,\n"
-            "    \"palette_height\": %u\n"
-            "}\n",
-            Tex2Str(txtr.hdr.format),
-            txtr.hdr.width,
-            txtr.hdr.height,
-            txtr.hdr.mipCount,
-            txtr.isIndexed ? Pal2Str(txtr.palHdr.format) : "",
-            txtr.isIndexed ? txtr.palHdr.width : 0,
-            txtr.isIndexed ? txtr.palHdr.height : 0
-        );
-    } else {
-        sloprintf(opts->noOutp, "Texture format: %s\nTexture dimensions: %ux%u\nTexture mipmaps: %u\n",
-            Tex2Str(txtr.hdr.format), txtr.hdr.width, txtr.hdr.height, txtr.hdr.mipCount);
-        if (txtr.isIndexed)
-            sloprintf(opts->noOutp, "Palette format: %s\nPalette dimensions: %ux%u\n", Pal2Str(txtr.palHdr.format),
-                txtr.palHdr.width, txtr.palHdr.height);
+    size_t count = 0;
+    for (int a = 0; a < argc; a++) {
+        char *eq = strchr(argv[a], '=');
+        size_t nameLen = eq ? (size_t) (eq - argv[a]) : 0;
+        bool isMetric = eq && nameLen == strlen("squishmetric") && !strncmp(argv[a], "squishmetric", nameLen);
+        const TTOptionField_t *f = eq && !isMetric ? findTargetField(argv[a], nameLen) : NULL;
+        
+        if (!f && !isMetric) {
+            if (!*argv[a]) {
+                eprintf("ERROR: Outputs must not be empty.\n");
+                free(targets);
+                return TTS_ERROR;
+            }
+            for (size_t t = 0; t < count; t++) {
+                if (!strcmp(targets[t].output, argv[a])) {
+                    eprintf("ERROR: Output \"%s\" is given more than once.\n", argv[a]);
+                    free(targets);
+                    return TTS_ERROR;
+                }
+            }
+            targets[count++] = (TTEncodeTarget_t) { .opts = *opts, .output = argv[a], .status = TTS_ERROR };
+            continue;
+        } else if (!count) {
+            eprintf("ERROR: Option \"%s\" must follow the output it is for.\n", argv[a]);
+            free(targets);
+            return TTS_ERROR;
+        }
+        
+        TTEncodeOptions_t *to = &targets[count - 1].opts;
+        if (isMetric) {
+            char *p = eq + 1;
+            size_t n = 0;
+            while (n < 3) {
+                char *end;
+                to->squishMetric[n++] = strtof(p, &end);
+                if (end == p) {
+                    n = 0;
+                    break;
+                }
+                p = end;
+                if (*p != ',')
+                    break;
+                p++;
+            }
+            if (*p || n != 3) {
+                eprintf("ERROR: %s: Metric must be 3 comma separated numbers.\n", argv[a]);
+                free(targets);
+                return TTS_ERROR;
+            }
+            to->squishMetricSz = 3;
+            to->squishMetricValid = true;
+        } else if (!setOptionField(f, to, eq + 1)) {
+            eprintf("ERROR: %s: Value must be %s.\n", argv[a], optionFieldTypeNames[f->type]);
+            free(targets);
+            return TTS_ERROR;
+        }
     }
     
-    TXTR_free(&txtr);
+    for (size_t t = 0; t < count; t++) {
+        TTEncodeOptions_t *to = &targets[t].opts;
+        to->squishMetricPtr = to->squishMetricValid ? to->squishMetric : SQUISH_DEFAULT_METRIC;
+        TTStatus_t eve = validateEncodeOptions(to);
+        if (eve) {
+            eprintf("ERROR: Invalid options for output \"%s\".\n", targets[t].output);
+            free(targets);
+            return eve;
+        }
+    }
     
+    *outTargets = targets;
+    *outCount = count;
     return TTS_SUCCESS;
 }
 #endif
 
-// optparse99 tasks
-static void printHelp(int argc, char **argv) {
-    optparse_print_help_subcmd_noexit(argc, argv);
-    exit(TTS_SUCCESS);
+// Serve tasks
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+// Sets the option field names in opts. Fields the job itself uses (id, cmd, input and output) are left alone.
+static TTStatus_t applyServeField(const TTOptionField_t *fields, size_t fieldCount, void *opts, TTJSONField_t *field,
+char *error, size_t errorSz) {
+    const TTOptionField_t *f = NULL;
+    for (size_t i = 0; i < fieldCount && !f; i++)
+        if (!strcmp(fields[i].name, field->key))
+            f = &fields[i];
+    if (!f) {
+        snprintf(error, errorSz, "Unknown field \"%s\"", field->key);
+        return TTS_ARGERROR;
+    }
+    
+    static const TTJSONType_t jsonTypes[] = {
+        [TTOF_FLAG] = TTJSON_BOOL,
+        [TTOF_STR] = TTJSON_STRING,
+        [TTOF_UINT8] = TTJSON_NUMBER,
+        [TTOF_UINT16] = TTJSON_NUMBER
+    };
+    if (field->type != jsonTypes[f->type] || !setOptionField(f, opts, field->value)) {
+        snprintf(error, errorSz, "Field \"%s\" must be %s", field->key, optionFieldTypeNames[f->type]);
+        return TTS_ARGERROR;
+    }
+    return TTS_SUCCESS;
 }
 
-static void printVersion(int argc, char **argv) {
-    FAKEREF(argc);
-    FAKEREF(argv);
-    oprintf("%s\n", TT_TITLE);
-    exit(TTS_SUCCESS);
+FORCE_INLINE bool isServeJobField(TTJSONField_t *field) {
+    return !strcmp(field->key, "id") || !strcmp(field->key, "cmd") || !strcmp(field->key, "input") ||
+        !strcmp(field->key, "output");
 }
 
 #ifdef TXTRTOOL_INCLUDE_DECODE
-static void setDecodeMode(int argc, char **argv) {
-    FAKEREF(argc);
-    FAKEREF(argv);
-    ttMode = TTM_DECODE;
+static TTStatus_t serveDecode(TTServer_t *server, TTJSONField_t *fields, size_t fieldCount, char *input, char *output,
+TTArena_t *arena, char *error, size_t errorSz) {
+    TTDecodeOptions_t opts = *server->decOpts;
+    opts.arena = arena;
+    for (size_t i = 0; i < fieldCount; i++) {
+        if (isServeJobField(&fields[i]))
+            continue;
+        TTStatus_t afe = applyServeField(decodeOptionFields, sizeof(decodeOptionFields) / sizeof(*decodeOptionFields),
+            &opts, &fields[i], error, errorSz);
+        if (afe)
+            return afe;
+    }
+    
+    // stdout carries the responses and there is nobody to answer prompts
+    opts.noOutp = true;
+    opts.noErrp = server->opts->noErrp;
+    opts.no = !opts.yes;
+    TTStatus_t dve = validateDecodeOptions(&opts);
+    if (dve) {
+        snprintf(error, errorSz, "Fields \"format\", \"mip\", \"mipRange\" and \"rect\" are invalid");
+        return dve;
+    }
+    return decode(&opts, input, output);
 }
 #endif
 
 #ifdef TXTRTOOL_INCLUDE_ENCODE
-static void setEncodeMode(int argc, char **argv) {
-    FAKEREF(argc);
-    FAKEREF(argv);
-    ttMode = TTM_ENCODE;
+static TTStatus_t serveEncode(TTServer_t *server, TTJSONField_t *fields, size_t fieldCount, char *input, char *output,
+TTArena_t *arena, TTResizeCache_t *resizeCache, char *error, size_t errorSz) {
+    TTEncodeOptions_t opts = *server->encOpts;
+    opts.arena = arena;
+    opts.resizeCache = resizeCache;
+    // Jobs already run side by side so like batch encode each only goes wide when asked to
+    opts.threads = 1;
+    for (size_t i = 0; i < fieldCount; i++) {
+        if (isServeJobField(&fields[i]))
+            continue;
+        
+        if (!strcmp(fields[i].key, "squishMetric")) {
+            double metric[3];
+            size_t metricSz = 0;
+            if (fields[i].type != TTJSON_ARRAY || TTJSON_ParseNumbers(fields[i].value, metric, 3, &metricSz) ||
+                metricSz != 3) {
+                snprintf(error, errorSz, "Field \"squishMetric\" must be an array of 3 numbers");
+                return TTS_ARGERROR;
+            }
+            for (size_t c = 0; c < 3; c++)
+                opts.squishMetric[c] = (float) metric[c];
+            opts.squishMetricSz = metricSz;
+            opts.squishMetricValid = true;
+            continue;
+        }
+        
+        TTStatus_t afe = applyServeField(encodeOptionFields, sizeof(encodeOptionFields) / sizeof(*encodeOptionFields),
+            &opts, &fields[i], error, errorSz);
+        if (afe)
+            return afe;
+    }
+    opts.squishMetricPtr = opts.squishMetricValid ? opts.squishMetric : SQUISH_DEFAULT_METRIC;
+    
+    opts.noOutp = true;
+    opts.noErrp = server->opts->noErrp;
+    opts.no = !opts.yes;
+    TTStatus_t eve = validateEncodeOptions(&opts);
+    if (eve) {
+        snprintf(error, errorSz, "Invalid encode options");
+        return eve;
+    }
+    return encode(&opts, input, output);
 }
 #endif
 
-#ifdef TXTRTOOL_INCLUDE_MISC
-static void setPrintMode(int argc, char **argv) {
-    FAKEREF(argc);
-    FAKEREF(argv);
-    ttMode = TTM_PRINT;
+// Runs one job line and answers with its id, status and how long it took
+static void serveJob(void *ctx, char *line, TTJSONBuf_t *reply, size_t worker) {
+    TTServer_t *server = ctx;
+    TTArena_t *arena = server->arenas ? &server->arenas[worker] : NULL;
+    uint64_t start = TTBench_Now();
+    char error[256] = "";
+    
+    TTJSONField_t fields[64];
+    size_t fieldCount = 0;
+    TTJSONField_t *id = NULL;
+    char *cmd = NULL;
+    char *input = NULL;
+    char *output = NULL;
+    TTStatus_t status = TTS_SUCCESS;
+    int poe = TTJSON_ParseObject(line, fields, sizeof(fields) / sizeof(*fields), &fieldCount);
+    if (poe) {
+        snprintf(error, sizeof(error), poe == E2BIG ? "Too many fields" : "Not a flat JSON object");
+        status = TTS_ARGERROR;
+    }
+    for (size_t i = 0; i < fieldCount; i++) {
+        char **to = !strcmp(fields[i].key, "cmd") ? &cmd : !strcmp(fields[i].key, "input") ? &input :
+            !strcmp(fields[i].key, "output") ? &output : NULL;
+        if (!strcmp(fields[i].key, "id"))
+            id = &fields[i];
+        else if (to && fields[i].type == TTJSON_STRING && *fields[i].value)
+            *to = fields[i].value;
+    }
+    
+    if (!status && (!cmd || !input || !output)) {
+        snprintf(error, sizeof(error), "Fields \"cmd\", \"input\" and \"output\" must be non empty strings");
+        status = TTS_ARGERROR;
+    }
+#ifdef TXTRTOOL_INCLUDE_DECODE
+    else if (!status && !strcmp(cmd, "decode"))
+        status = serveDecode(server, fields, fieldCount, input, output, arena, error, sizeof(error));
+#endif
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+    else if (!status && !strcmp(cmd, "encode"))
+        status = serveEncode(server, fields, fieldCount, input, output, arena,
+            server->resizeCaches ? &server->resizeCaches[worker] : NULL, error, sizeof(error));
+#endif
+    else if (!status) {
+        snprintf(error, sizeof(error), "Unknown cmd \"%s\"", cmd);
+        status = TTS_ARGERROR;
+    }
+    if (arena)
+        TTArena_Reset(arena);
+    
+    TTJSONBuf_Printf(reply, "{\"id\":");
+    if (!id)
+        TTJSONBuf_Printf(reply, "null");
+    else if (id->type == TTJSON_STRING)
+        TTJSONBuf_String(reply, id->value);
+    else
+        TTJSONBuf_Printf(reply, "%s", id->value);
+    TTJSONBuf_Printf(reply, ",\"status\":\"%s\",\"code\":%i,\"ms\":%.3f", Status2Str(status), (int) status,
+        (double) (TTBench_Now() - start) / 1e6);
+    if (*error) {
+        TTJSONBuf_Printf(reply, ",\"error\":");
+        TTJSONBuf_String(reply, error);
+    }
+    TTJSONBuf_Printf(reply, "}");
+}
+
+static TTStatus_t serve(TTServer_t *server) {
+    TTServeOptions_t *opts = server->opts;
+    // Without a socket stdout is where responses go
+    bool noOutp = opts->noOutp || !opts->socket;
+    
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+    server->encOpts->noOutp = noOutp;
+    server->encOpts->noErrp = opts->noErrp;
+    TTCache_t cache;
+    TTStatus_t oce = openEncodeCache(server->encOpts, &cache);
+    if (oce)
+        return oce;
+#endif
+    
+    size_t workers = TTPool_ThreadCount(opts->jobs, SIZE_MAX);
+    if (opts->socket)
+        sloprintf(noOutp, "Serving on \"%s\" with %zu worker%s...\n", opts->socket, workers, workers != 1 ? "s" : "");
+    // Like batch workers every serve worker reuses one arena across its jobs, or the heap if they can't be had
+    server->arenas = malloc(workers * sizeof(*server->arenas));
+    if (server->arenas)
+        for (size_t w = 0; w < workers; w++)
+            TTArena_Init(&server->arenas[w], 0);
+    // And its own resize cache, which like batch's only encode jobs with concurrentMips use
+    server->resizeCaches = malloc(workers * sizeof(*server->resizeCaches));
+    if (server->resizeCaches)
+        for (size_t w = 0; w < workers; w++)
+            TTResizeCache_Init(&server->resizeCaches[w]);
+    int sre = TTServe_Run(opts->socket, workers, serveJob, server);
+    if (server->arenas) {
+        for (size_t w = 0; w < workers; w++)
+            TTArena_Free(&server->arenas[w]);
+        free(server->arenas);
+        server->arenas = NULL;
+    }
+    if (server->resizeCaches) {
+        for (size_t w = 0; w < workers; w++)
+            TTResizeCache_Free(&server->resizeCaches[w]);
+        free(server->resizeCaches);
+        server->resizeCaches = NULL;
+    }
+    
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+    closeEncodeCache(server->encOpts);
+#endif
+    if (sre) {
+        sleprintf(opts->noErrp, "ERROR: Failed to serve%s%s%s: %s\n", opts->socket ? " on \"" : "",
+            opts->socket ? opts->socket : "", opts->socket ? "\"" : "", strerror(sre));
+        return sre == ENOMEM ? TTS_MEMERROR : TTS_IOERROR;
+    }
+    
+    return TTS_SUCCESS;
 }
 #endif
 
@@ -982,8 +3753,15 @@ int main(int argc, char **argv) {
         .yes = (int) false,
         .no = (int) false,
         .mipmaps = (int) false,
+        .mip = 0,
+        .mipRange = NULL,
+        .rect = NULL,
         .prefix = "",
-        .suffix = ""
+        .suffix = "",
+        .format = "tga",
+        .legacyOrigin = (int) false,
+        .directDecode = (int) false,
+        .arena = NULL
     };
 #endif
     
@@ -1006,7 +3784,7 @@ int main(int argc, char **argv) {
         .stbirEdgeDec = STBIR_EDGE_CLAMP,
         .stbirFilter = TOSTR(DEFAULT),
         .stbirFilterDec = STBIR_FILTER_DEFAULT,
-        .ditherType = TOSTR(THRESHOLD),
+        .ditherType = NULL,
         .ditherTypeDec = GX_DT_THRESHOLD,
         .squishMetricPtr = NULL,
         .squishMetricSz = 0,
@@ -1016,25 +3794,402 @@ int main(int argc, char **argv) {
         .squishClusterFit = (int) false,
         .squishRangeFit = (int) false,
         .squishIterClusterFit = (int) false,
-        .squishFlags = 0
+        .squishFlags = 0,
+        .concurrentMips = (int) false,
+        .quantize = (int) false,
+        .legacyOrigin = (int) false,
+        .threads = 1,
+        .cacheDir = NULL,
+        .cacheSize = 1024,
+        .cache = NULL,
+        .arena = NULL,
+        .resizeCache = NULL
+    };
+#endif
+    
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+    TTBatchOptions_t batOpts = {
+        .jobs = 0,
+        .memBudget = 0
+    };
+    
+    TTServeOptions_t srvOpts = {
+        .noOutp = (int) false,
+        .noErrp = (int) false,
+        .jobs = 0,
+        .socket = NULL
+    };
+#endif
+    
+#ifdef TXTRTOOL_INCLUDE_DECODE
+    TTThumbOptions_t thmOpts = {
+        .noOutp = (int) false,
+        .noErrp = (int) false,
+        .yes = (int) false,
+        .no = (int) false,
+        .size = 128,
+        .exact = (int) false,
+        .legacyOrigin = (int) false
+    };
+#endif
+    
+#ifdef TXTRTOOL_INCLUDE_MISC
+    TTPrintOptions_t prtOpts = {
+        .noOutp = (int) false,
+        .noErrp = (int) false,
+        .json = (int) false,
+        .validate = (int) false
+    };
+#endif
+    
+#if defined(TXTRTOOL_INCLUDE_ENCODE) && defined(TXTRTOOL_INCLUDE_MISC)
+    TTBenchOptions_t bchOpts = {
+        .noOutp = (int) false,
+        .noErrp = (int) false,
+        .json = (int) false,
+        .iterations = 3,
+        .mipLimit = 1,
+        .texFmt = NULL,
+        .checkKernels = (int) false,
+        .directDecode = (int) false
+    };
+#endif
+    
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#ifdef TXTRTOOL_INCLUDE_DECODE
+    // Shared by decode and batch decode
+    struct optparse_opt decOptList[] = {
+        {
+            .short_name = 's',
+            .long_name = "nooutp",
+            .flag = &decOpts.noOutp,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Do not print output."
+        },
+        {
+            .short_name = 'e',
+            .long_name = "noerrp",
+            .flag = &decOpts.noErrp,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Do not print errors."
+        },
+        {
+            .short_name = 'y',
+            .long_name = "yes",
+            .flag = &decOpts.yes,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Assume yes to every prompt."
+        },
+        {
+            .short_name = 'n',
+            .long_name = "no",
+            .flag = &decOpts.no,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Assume no to every prompt."
+        },
+        {
+            .short_name = 'm',
+            .long_name = "mipmaps",
+            .flag = &decOpts.mipmaps,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Decode all mipmaps from the TXTR. Outputs to a directory instead."
+        },
+        {
+            .short_name = 'i',
+            .long_name = "mip",
+            .arg_name = "uint8",
+            .arg_data_type = DATA_TYPE_UINT8,
+            .arg_storage = &decOpts.mip,
+            .description = "Decode only this mipmap (1 is the full size one) to the output file. Mipmaps before it are "
+                "skipped without being decoded. 0 means not set. (Default: 0)"
+        },
+        {
+            .short_name = 'r',
+            .long_name = "mips",
+            .arg_name = "range",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &decOpts.mipRange,
+            .description = "Decode only mipmaps A to B (written as A-B, or A for one) like --mipmaps, which this "
+                "implies. Mipmaps outside the range are not decoded. (Default: all)"
+        },
+        {
+            .short_name = 'c',
+            .long_name = "rect",
+            .arg_name = "x,y,w,h",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &decOpts.rect,
+            .description = "Decode only the w x h rectangle at x,y of the mipmap (see --mip). Only the tiles it "
+                "touches are decoded for formats that aren't indexed."
+        },
+        {
+            .short_name = 'b',
+            .long_name = "prefix",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &decOpts.prefix,
+            .description = "Prefix for each mipmap file name. This only has effect if --mipmaps "
+                "specified. (Default: )"
+        },
+        {
+            .short_name = 'a',
+            .long_name = "suffix",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &decOpts.suffix,
+            .description = "Suffix for each mipmap file name. This only has effect if --mipmaps "
+                "specified. (Default: )"
+        },
+        {
+            .short_name = 'f',
+            .long_name = "format",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &decOpts.format,
+            .description = "The format to write. dds writes a " TOSTR(CMP) " TXTR's mipmaps (all of them unless "
+                "--mip or --mips pick some) to one BC1 DDS without decoding them. Valid values: " DecFmtList(", ")
+                " (Default: tga)"
+        },
+        {
+            .long_name = "legacyorigin",
+            .flag = &decOpts.legacyOrigin,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Flip indexed textures' rows and write bottom to top TGAs like older versions did, for "
+                "tools that ignore the TGA origin bit."
+        },
+        {
+            .long_name = "directdecode",
+            .flag = &decOpts.directDecode,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Decode textures that aren't indexed with txtrtool's own kernels straight from the file "
+                "instead of the txtr library. Faster and uses less memory, but not yet checked to give the same "
+                "pixels as the txtr library for every texture."
+        },
+        { END_OF_OPTIONS }
     };
 #endif
     
-#ifdef TXTRTOOL_INCLUDE_MISC
-    TTPrintOptions_t prtOpts = {
-        .noOutp = (int) false,
-        .noErrp = (int) false,
-        .json = (int) false
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+    // Shared by encode and batch encode
+    struct optparse_opt encOptList[] = {
+        {
+            .short_name = 's',
+            .long_name = "nooutp",
+            .flag = &encOpts.noOutp,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Do not print output."
+        },
+        {
+            .short_name = 'e',
+            .long_name = "noerrp",
+            .flag = &encOpts.noErrp,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Do not print errors."
+        },
+        {
+            .short_name = 'y',
+            .long_name = "yes",
+            .flag = &encOpts.yes,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Assume yes to every prompt."
+        },
+        {
+            .short_name = 'n',
+            .long_name = "no",
+            .flag = &encOpts.no,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Assume no to every prompt."
+        },
+        {
+            .short_name = 't',
+            .long_name = "texfmt",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &encOpts.texFmt,
+            .description = "The texture format to set for the output TXTR. Valid values: " TexList(", ")
+                " (Default: " TOSTR(RGBA8) ")"
+        },
+        {
+            .short_name = 'p',
+            .long_name = "palfmt",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &encOpts.palFmt,
+            .description = "For " TOSTR(CI4) ", " TOSTR(CI8) ", and " TOSTR(CI14X2) ": The palette format "
+                "to set for the output TXTR. Valid values: " PalList(", ") " (Default: " TOSTR(RGB5A3) ")"
+        },
+        {
+            .short_name = 'm',
+            .long_name = "miplimit",
+            .arg_name = "uint8",
+            .arg_data_type = DATA_TYPE_UINT8,
+            .arg_storage = &encOpts.mipLimit,
+            .description = "The maximum limit of mipmaps to encode. 0 means no limit ergo 11 mipmaps. "
+                "This must be greater than or equal to 0 and less than 12. For " TOSTR(CI4) ", " TOSTR(CI8)
+                ", and " TOSTR(CI14X2) ": this must be 1 or 0 and 0 means 1 instead of 11. (Default: 1)"
+        },
+        {
+            .short_name = 'w',
+            .long_name = "widthlimit",
+            .arg_name = "uint16",
+            .arg_data_type = DATA_TYPE_UINT16,
+            .arg_storage = &encOpts.widthLimit,
+            .description = "The minimum limit of mipmap width. Must be greater than 0. (Default: 1)"
+        },
+        {
+            .short_name = 'h',
+            .long_name = "heightlimit",
+            .arg_name = "uint16",
+            .arg_data_type = DATA_TYPE_UINT16,
+            .arg_storage = &encOpts.heightLimit,
+            .description = "The minimum limit of mipmap height. Must be greater than 0. (Default: 1)"
+        },
+        {
+            .long_name = "avgtype",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &encOpts.avgType,
+            .description = "For " TOSTR(I4) ", " TOSTR(I8) ", " TOSTR(IA4) ", and " TOSTR(IA8) ": The "
+                "formula to use for greyscaling. Valid values: " AvgTypList(", ") " (Default: "
+                TOSTR(AVERAGE) ")"
+        },
+        {
+            .long_name = "stbiredge",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &encOpts.stbirEdge,
+            .description = "The type of edge mode to use for mipmaps. Valid values: " EdgeList(", ")
+                " (Default: " TOSTR(CLAMP) ")"
+        },
+        {
+            .long_name = "stbirfilter",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &encOpts.stbirFilter,
+            .description = "The type of filter to use for mipmaps. Valid values: " FilterList(", ")
+                " (Default: " TOSTR(DEFAULT) ")"
+        },
+        {
+            .long_name = "dithertype",
+            .arg_name = "string",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &encOpts.ditherType,
+            .description = "For " TOSTR(CI4) ", " TOSTR(CI8) ", and " TOSTR(CI14X2) ": The type of dither "
+                "operation during quantization. Valid values: "
+                DitherTypeList(", ") " (Default: " TOSTR(THRESHOLD) ")"
+        },
+        {
+            .long_name = "squishmetric",
+            .arg_name = "float,float,float",
+            .arg_data_type = DATA_TYPE_FLT,
+            .arg_delim = ",",
+            .arg_storage = &encOpts.squishMetricPtr,
+            .arg_storage_size = &encOpts.squishMetricSz,
+            .description = "For " TOSTR(CMP) ": An optional perceptual metric used to weight the relative "
+                "importance of each colour channel. (Default: 1.0,1.0,1.0)"
+        },
+        {
+            .long_name = "squishalphaweight",
+            .flag = &encOpts.squishAlphaWeight,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "For " TOSTR(CMP) ": Weight the color by alpha during cluster fit. This has no "
+                "effect if --squishrangefit specified."
+        },
+        {
+            .long_name = "squishclusterfit",
+            .flag = &encOpts.squishClusterFit,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .group = 1,
+            .description = "For " TOSTR(CMP) ": Use a slow but high quality compressor (Default)."
+        },
+        {
+            .long_name = "squishrangefit",
+            .flag = &encOpts.squishRangeFit,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .group = 1,
+            .description = "For " TOSTR(CMP) ": Use a fast but low quality compressor."
+        },
+        {
+            .long_name = "squishiterclusterfit",
+            .flag = &encOpts.squishIterClusterFit,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .group = 1,
+            .description = "For " TOSTR(CMP) ": Use a very slow but very high quality compressor."
+        },
+        {
+            .short_name = 'c',
+            .long_name = "concurrentmips",
+            .flag = &encOpts.concurrentMips,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Resize and encode every mipmap on its own thread instead of one after another. The "
+                "mipmaps are resized by txtrtool rather than the txtr library, so every mipmap after the first can "
+                "differ in bytes from an encode without this option. This has no effect on " TOSTR(CI4) ", "
+                TOSTR(CI8) ", and " TOSTR(CI14X2) "."
+        },
+        {
+            .long_name = "quantize",
+            .flag = &encOpts.quantize,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "For " TOSTR(CI4) ", " TOSTR(CI8) ", and " TOSTR(CI14X2) ": Build the palette and "
+                "dither with txtrtool's own quantizer (median cut with a k-d tree nearest color search) before "
+                "encoding. Meant for large palettes where searching every palette color for every pixel is slow."
+        },
+        {
+            .long_name = "legacyorigin",
+            .flag = &encOpts.legacyOrigin,
+            .flag_type = FLAG_TYPE_SET_TRUE,
+            .description = "Ignore the input TGA's origin bit and take its rows as bottom to top like older "
+                "versions did."
+        },
+        {
+            .short_name = 'T',
+            .long_name = "threads",
+            .arg_name = "uint16",
+            .arg_data_type = DATA_TYPE_UINT16,
+            .arg_storage = &encOpts.threads,
+            .description = "Number of threads to encode with. For " TOSTR(CMP) " the image is split into bands of "
+                "whole tile rows which are compressed in parallel. Each band is compressed on its own so the output "
+                "is expected to match 1 thread but this has not been checked against every txtr library build. "
+                "With --quantize the dither runs over rows in parallel with the same output. 0 means one per "
+                "logical processor. (Default: 1)"
+        },
+        {
+            .long_name = "cache",
+            .arg_name = "dir",
+            .arg_data_type = DATA_TYPE_STR,
+            .arg_storage = &encOpts.cacheDir,
+            .description = "Keep encoded TXTRs in the cache directory dir keyed by the input's pixels and the encode "
+                "options. When an input was already encoded with the same options the cached TXTR is copied to the "
+                "output instead of encoding again."
+        },
+        {
+            .long_name = "cachesize",
+            .arg_name = "uint16",
+            .arg_data_type = DATA_TYPE_UINT16,
+            .arg_storage = &encOpts.cacheSize,
+            .description = "Size limit of --cache in MiB. The least recently used entries are evicted once it is "
+                "exceeded. 0 means no limit. (Default: 1024)"
+        },
+        { END_OF_OPTIONS }
     };
 #endif
     
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
     struct optparse_cmd mainCmd = {
         .name = "txtrtool",
         .about = TT_ABOUT,
         .description = TT_DESCRIPTION,
         .function = printHelp,
+        .options = (struct optparse_opt[]) {
+            {
+                .long_name = "isa",
+                .arg_name = "string",
+                .arg_data_type = DATA_TYPE_STR,
+                .arg_storage = &ttISA,
+                .description = "Instruction set to run the tool's kernels with instead of the best one the CPU "
+                    "supports. The version subcommand shows which one is used. Valid values: " ISAList(", ")
+            },
+            { END_OF_OPTIONS }
+        },
         .subcommands = (struct optparse_cmd[]) {
             {
                 .name = "help",
@@ -1051,61 +4206,69 @@ int main(int argc, char **argv) {
             {
                 .name = "decode",
                 .about = "Decode a TXTR to a TGA or a set of TGAs for every mipmap.",
-                .operands = "<input txtr> <output tga/output directory>",
+                .description = "With --format dds a CMP TXTR is instead transcoded to a BC1 DDS.",
+                .operands = "<input txtr> <output tga/output directory/output dds>",
                 .function = setDecodeMode,
+                .options = decOptList
+            },
+            {
+                .name = "thumb",
+                .about = "Decode a thumbnail of a TXTR from the smallest mipmap at least a given size.",
+                .description = "Only the chosen mipmap is decoded: the smallest one whose longer edge is at least "
+                    "--size, or the first one if the texture is smaller.",
+                .operands = "<input txtr> <output tga>",
+                .function = setThumbMode,
                 .options = (struct optparse_opt[]) {
                     {
                         .short_name = 's',
                         .long_name = "nooutp",
-                        .flag = &decOpts.noOutp,
+                        .flag = &thmOpts.noOutp,
                         .flag_type = FLAG_TYPE_SET_TRUE,
                         .description = "Do not print output."
                     },
                     {
                         .short_name = 'e',
                         .long_name = "noerrp",
-                        .flag = &decOpts.noErrp,
+                        .flag = &thmOpts.noErrp,
                         .flag_type = FLAG_TYPE_SET_TRUE,
                         .description = "Do not print errors."
                     },
                     {
                         .short_name = 'y',
                         .long_name = "yes",
-                        .flag = &decOpts.yes,
+                        .flag = &thmOpts.yes,
                         .flag_type = FLAG_TYPE_SET_TRUE,
                         .description = "Assume yes to every prompt."
                     },
                     {
                         .short_name = 'n',
                         .long_name = "no",
-                        .flag = &decOpts.no,
+                        .flag = &thmOpts.no,
                         .flag_type = FLAG_TYPE_SET_TRUE,
                         .description = "Assume no to every prompt."
                     },
                     {
-                        .short_name = 'm',
-                        .long_name = "mipmaps",
-                        .flag = &decOpts.mipmaps,
-                        .flag_type = FLAG_TYPE_SET_TRUE,
-                        .description = "Decode all mipmaps from the TXTR. Outputs to a directory instead."
+                        .short_name = 'z',
+                        .long_name = "size",
+                        .arg_name = "uint16",
+                        .arg_data_type = DATA_TYPE_UINT16,
+                        .arg_storage = &thmOpts.size,
+                        .description = "Edge length the thumbnail's longer edge should be at least. (Default: 128)"
                     },
                     {
-                        .short_name = 'b',
-                        .long_name = "prefix",
-                        .arg_name = "string",
-                        .arg_data_type = DATA_TYPE_STR,
-                        .arg_storage = &decOpts.prefix,
-                        .description = "Prefix for each mipmap file name. This only has effect if --mipmaps "
-                            "specified. (Default: )"
+                        .short_name = 'x',
+                        .long_name = "exact",
+                        .flag = &thmOpts.exact,
+                        .flag_type = FLAG_TYPE_SET_TRUE,
+                        .description = "Resize the chosen mipmap the rest of the way down so its longer edge is "
+                            "exactly --size."
                     },
                     {
-                        .short_name = 'a',
-                        .long_name = "suffix",
-                        .arg_name = "string",
-                        .arg_data_type = DATA_TYPE_STR,
-                        .arg_storage = &decOpts.suffix,
-                        .description = "Suffix for each mipmap file name. This only has effect if --mipmaps "
-                            "specified. (Default: )"
+                        .long_name = "legacyorigin",
+                        .flag = &thmOpts.legacyOrigin,
+                        .flag_type = FLAG_TYPE_SET_TRUE,
+                        .description = "Flip indexed textures' rows and write a bottom to top TGA like older "
+                            "versions did."
                     },
                     { END_OF_OPTIONS }
                 }
@@ -1115,185 +4278,280 @@ int main(int argc, char **argv) {
             {
                 .name = "encode",
                 .about = "Encode a TGA to a TXTR.",
-                .operands = "<input tga> <output txtr>",
+                .description = "More than one output may be given, each followed by <option>=<value> operands "
+                    "overriding the options for it alone (long option names without dashes, e.g. texfmt=CMPR, "
+                    "squishmetric=1,1,1). The input is read once for every output. Only outputs with --concurrentmips "
+                    "also share mipmaps, resized once per edge mode and filter; the others have TXTR_Encode resize "
+                    "their own so each output matches encoding it alone. The outputs are then encoded in parallel "
+                    "with --threads split between them. Prompts are asked before encoding. "
+                    "A BC1 DDS input (.dds) is transcoded to CMP with its own mipmaps instead of being encoded, so "
+                    "only --texfmt " TOSTR(CMP) " applies to it.",
+                .operands = "<input tga/input dds> <output txtr> [<option>=<value>...] [<output txtr> "
+                    "[<option>=<value>...]...]",
                 .function = setEncodeMode,
+                .options = encOptList
+            },
+#endif
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+            {
+                .name = "batch",
+                .about = "Run a subcommand over every file of a directory tree or manifest on a worker pool.",
+                .description = "The input is either a directory (searched recursively, not following symlinked "
+                    "directories) or a manifest file with one input path per line, optionally followed by a tab and "
+                    "an output path. Outputs keep their path relative to the input directory. Prompts cannot be "
+                    "shown while workers run so unless --yes is given every per-file prompt is answered no. Inputs "
+                    "are memory mapped while parsed, but the txtr and tga libraries copy what they read so every input "
+                    "being worked on is still held in memory in full. Encodes with --concurrentmips keep each "
+                    "worker's resize setup between files of the same size, without it every file is resized by the "
+                    "txtr library.",
+                .function = printHelp,
                 .options = (struct optparse_opt[]) {
                     {
-                        .short_name = 's',
-                        .long_name = "nooutp",
-                        .flag = &encOpts.noOutp,
-                        .flag_type = FLAG_TYPE_SET_TRUE,
-                        .description = "Do not print output."
-                    },
-                    {
-                        .short_name = 'e',
-                        .long_name = "noerrp",
-                        .flag = &encOpts.noErrp,
-                        .flag_type = FLAG_TYPE_SET_TRUE,
-                        .description = "Do not print errors."
-                    },
-                    {
-                        .short_name = 'y',
-                        .long_name = "yes",
-                        .flag = &encOpts.yes,
-                        .flag_type = FLAG_TYPE_SET_TRUE,
-                        .description = "Assume yes to every prompt."
+                        .short_name = 'j',
+                        .long_name = "jobs",
+                        .arg_name = "uint16",
+                        .arg_data_type = DATA_TYPE_UINT16,
+                        .arg_storage = &batOpts.jobs,
+                        .description = "Number of files to process at once. 0 means one per logical processor. "
+                            "(Default: 0)"
                     },
                     {
-                        .short_name = 'n',
-                        .long_name = "no",
-                        .flag = &encOpts.no,
-                        .flag_type = FLAG_TYPE_SET_TRUE,
-                        .description = "Assume no to every prompt."
+                        .short_name = 'M',
+                        .long_name = "membudget",
+                        .arg_name = "uint16",
+                        .arg_data_type = DATA_TYPE_UINT16,
+                        .arg_storage = &batOpts.memBudget,
+                        .description = "For decode: Memory budget in MiB. A file only starts decoding once the memory "
+                            "estimated from its header fits alongside the files already decoding. 0 means no limit. "
+                            "(Default: 0)"
                     },
+                    { END_OF_OPTIONS }
+                },
+                .subcommands = (struct optparse_cmd[]) {
+#ifdef TXTRTOOL_INCLUDE_ENCODE
                     {
-                        .short_name = 't',
-                        .long_name = "texfmt",
-                        .arg_name = "string",
-                        .arg_data_type = DATA_TYPE_STR,
-                        .arg_storage = &encOpts.texFmt,
-                        .description = "The texture format to set for the output TXTR. Valid values: " TexList(", ")
-                            " (Default: " TOSTR(RGBA8) ")"
+                        .name = "encode",
+                        .about = "Encode every TGA to a TXTR.",
+                        .operands = "<input directory/manifest> <output directory>",
+                        .function = setBatchEncodeMode,
+                        .options = encOptList
                     },
+#endif
+#ifdef TXTRTOOL_INCLUDE_DECODE
                     {
-                        .short_name = 'p',
-                        .long_name = "palfmt",
-                        .arg_name = "string",
-                        .arg_data_type = DATA_TYPE_STR,
-                        .arg_storage = &encOpts.palFmt,
-                        .description = "For " TOSTR(CI4) ", " TOSTR(CI8) ", and " TOSTR(CI14X2) ": The palette format "
-                            "to set for the output TXTR. Valid values: " PalList(", ") " (Default: " TOSTR(RGB5A3) ")"
+                        .name = "decode",
+                        .about = "Decode every TXTR to a TGA or a set of TGAs for every mipmap.",
+                        .operands = "<input directory/manifest> <output directory>",
+                        .function = setBatchDecodeMode,
+                        .options = decOptList
                     },
+#endif
+                    { END_OF_SUBCOMMANDS }
+                }
+            },
+#endif
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+            {
+                .name = "serve",
+                .about = "Keep running and take encode and decode jobs as JSON lines from stdin or a UNIX socket.",
+                .description = "Every line is a JSON object with \"cmd\" (\"encode\" or \"decode\"), \"input\", "
+                    "\"output\", an optional \"id\" and any of the subcommand's options named like the fields of "
+                    "its options (e.g. \"texFmt\": \"CMP\", \"mipLimit\": 0, \"squishMetric\": [1, 1, 1], "
+                    "\"mipmaps\": true). Options not given keep their defaults, except threads which is 1. Every "
+                    "job is answered with a line of its id, status, status code and time taken in milliseconds, plus "
+                    "an error for jobs that could not be started, in the order jobs finish. Without --socket jobs are "
+                    "read from stdin until it ends and answered on stdout. Prompts cannot be shown so unless a job "
+                    "has \"yes\": true they are answered no. Like batch, encode jobs with \"concurrentMips\": true "
+                    "keep each worker's resize setup between inputs of the same size.",
+                .function = setServeMode,
+                .options = (struct optparse_opt[]) {
                     {
-                        .short_name = 'm',
-                        .long_name = "miplimit",
-                        .arg_name = "uint8",
-                        .arg_data_type = DATA_TYPE_UINT8,
-                        .arg_storage = &encOpts.mipLimit,
-                        .description = "The maximum limit of mipmaps to encode. 0 means no limit ergo 11 mipmaps. "
-                            "This must be greater than or equal to 0 and less than 12. For " TOSTR(CI4) ", " TOSTR(CI8)
-                            ", and " TOSTR(CI14X2) ": this must be 1 or 0 and 0 means 1 instead of 11. (Default: 1)"
+                        .short_name = 's',
+                        .long_name = "nooutp",
+                        .flag = &srvOpts.noOutp,
+                        .flag_type = FLAG_TYPE_SET_TRUE,
+                        .description = "Do not print output other than job responses."
                     },
                     {
-                        .short_name = 'w',
-                        .long_name = "widthlimit",
-                        .arg_name = "uint16",
-                        .arg_data_type = DATA_TYPE_UINT16,
-                        .arg_storage = &encOpts.widthLimit,
-                        .description = "The minimum limit of mipmap width. Must be greater than 0. (Default: 1)"
+                        .short_name = 'e',
+                        .long_name = "noerrp",
+                        .flag = &srvOpts.noErrp,
+                        .flag_type = FLAG_TYPE_SET_TRUE,
+                        .description = "Do not print errors."
                     },
                     {
-                        .short_name = 'h',
-                        .long_name = "heightlimit",
+                        .short_name = 'j',
+                        .long_name = "jobs",
                         .arg_name = "uint16",
                         .arg_data_type = DATA_TYPE_UINT16,
-                        .arg_storage = &encOpts.heightLimit,
-                        .description = "The minimum limit of mipmap height. Must be greater than 0. (Default: 1)"
-                    },
-                    {
-                        .long_name = "avgtype",
-                        .arg_name = "string",
-                        .arg_data_type = DATA_TYPE_STR,
-                        .arg_storage = &encOpts.avgType,
-                        .description = "For " TOSTR(I4) ", " TOSTR(I8) ", " TOSTR(IA4) ", and " TOSTR(IA8) ": The "
-                            "formula to use for greyscaling. Valid values: " AvgTypList(", ") " (Default: "
-                            TOSTR(AVERAGE) ")"
-                    },
-                    {
-                        .long_name = "stbiredge",
-                        .arg_name = "string",
-                        .arg_data_type = DATA_TYPE_STR,
-                        .arg_storage = &encOpts.stbirEdge,
-                        .description = "The type of edge mode to use for mipmaps. Valid values: " EdgeList(", ")
-                            " (Default: " TOSTR(CLAMP) ")"
+                        .arg_storage = &srvOpts.jobs,
+                        .description = "Number of jobs to run at once. 0 means one per logical processor. "
+                            "(Default: 0)"
                     },
                     {
-                        .long_name = "stbirfilter",
+                        .short_name = 'u',
+                        .long_name = "socket",
                         .arg_name = "string",
                         .arg_data_type = DATA_TYPE_STR,
-                        .arg_storage = &encOpts.stbirFilter,
-                        .description = "The type of filter to use for mipmaps. Valid values: " FilterList(", ")
-                            " (Default: " TOSTR(DEFAULT) ")"
+                        .arg_storage = &srvOpts.socket,
+                        .description = "Listen on a UNIX socket at this path instead of reading stdin. Only your user "
+                            "may connect. Every connection gets the responses to its own jobs. Runs until "
+                            "interrupted. Not supported on Windows."
                     },
+#ifdef TXTRTOOL_INCLUDE_ENCODE
                     {
-                        .long_name = "dithertype",
+                        .long_name = "cache",
                         .arg_name = "string",
                         .arg_data_type = DATA_TYPE_STR,
-                        .arg_storage = &encOpts.ditherType,
-                        .description = "For " TOSTR(CI4) ", " TOSTR(CI8) ", and " TOSTR(CI14X2) ": The type of dither "
-                            "operation during quantization. Valid values: "
-                            DitherTypeList(", ") " (Default: " TOSTR(THRESHOLD) ")"
+                        .arg_storage = &encOpts.cacheDir,
+                        .description = "Like encode's --cache, shared by every encode job."
                     },
                     {
-                        .long_name = "squishmetric",
-                        .arg_name = "float,float,float",
-                        .arg_data_type = DATA_TYPE_FLT,
-                        .arg_delim = ",",
-                        .arg_storage = &encOpts.squishMetricPtr,
-                        .arg_storage_size = &encOpts.squishMetricSz,
-                        .description = "For " TOSTR(CMP) ": An optional perceptual metric used to weight the relative "
-                            "importance of each colour channel. (Default: 1.0,1.0,1.0)"
+                        .long_name = "cachesize",
+                        .arg_name = "uint16",
+                        .arg_data_type = DATA_TYPE_UINT16,
+                        .arg_storage = &encOpts.cacheSize,
+                        .description = "Size limit of --cache in MiB. 0 means no limit. (Default: 1024)"
                     },
+#endif
+                    { END_OF_OPTIONS }
+                }
+            },
+#endif
+#ifdef TXTRTOOL_INCLUDE_MISC
+            {
+                .name = "print",
+                .about = "Print information of a TXTR such as its format, dimensions, etc.",
+                .operands = "<input txtr>",
+                .function = setPrintMode,
+                .options = (struct optparse_opt[]) {
                     {
-                        .long_name = "squishalphaweight",
-                        .flag = &encOpts.squishAlphaWeight,
+                        .short_name = 's',
+                        .long_name = "nooutp",
+                        .flag = &prtOpts.noOutp,
                         .flag_type = FLAG_TYPE_SET_TRUE,
-                        .description = "For " TOSTR(CMP) ": Weight the color by alpha during cluster fit. This has no "
-                            "effect if --squishrangefit specified."
+                        .description = "Do not print output."
                     },
                     {
-                        .long_name = "squishclusterfit",
-                        .flag = &encOpts.squishClusterFit,
+                        .short_name = 'e',
+                        .long_name = "noerrp",
+                        .flag = &prtOpts.noErrp,
                         .flag_type = FLAG_TYPE_SET_TRUE,
-                        .group = 1,
-                        .description = "For " TOSTR(CMP) ": Use a slow but high quality compressor (Default)."
+                        .description = "Do not print errors."
                     },
                     {
-                        .long_name = "squishrangefit",
-                        .flag = &encOpts.squishRangeFit,
+                        .short_name = 'j',
+                        .long_name = "json",
+                        .flag = &prtOpts.json,
                         .flag_type = FLAG_TYPE_SET_TRUE,
-                        .group = 1,
-                        .description = "For " TOSTR(CMP) ": Use a fast but low quality compressor."
+                        .description = "Print output to JSON formatted data."
                     },
                     {
-                        .long_name = "squishiterclusterfit",
-                        .flag = &encOpts.squishIterClusterFit,
+                        .short_name = 'V',
+                        .long_name = "validate",
+                        .flag = &prtOpts.validate,
                         .flag_type = FLAG_TYPE_SET_TRUE,
-                        .group = 1,
-                        .description = "For " TOSTR(CMP) ": Use a very slow but very high quality compressor."
+                        .description = "Read the whole TXTR to check it is valid instead of only its header."
                     },
                     { END_OF_OPTIONS }
                 }
             },
 #endif
-#ifdef TXTRTOOL_INCLUDE_MISC
+#if defined(TXTRTOOL_INCLUDE_ENCODE) && defined(TXTRTOOL_INCLUDE_MISC)
             {
-                .name = "print",
-                .about = "Print information of a TXTR such as its format, dimensions, etc.",
-                .operands = "<input txtr>",
-                .function = setPrintMode,
+                .name = "bench",
+                .about = "Measure encode and decode speed of every format over a set of TGAs.",
+                .description = "Every texture format is encoded and decoded in-process, indexed formats with every "
+                    "palette format and dither type and " TOSTR(CMP) " with every squish fit. Reports throughput, "
+                    "latency and (when built with TXTRTOOL_BENCH_ALLOCS) heap allocations per call.",
+                .operands = "<input tga>...",
+                .function = setBenchMode,
                 .options = (struct optparse_opt[]) {
                     {
                         .short_name = 's',
                         .long_name = "nooutp",
-                        .flag = &prtOpts.noOutp,
+                        .flag = &bchOpts.noOutp,
                         .flag_type = FLAG_TYPE_SET_TRUE,
                         .description = "Do not print output."
                     },
                     {
                         .short_name = 'e',
                         .long_name = "noerrp",
-                        .flag = &prtOpts.noErrp,
+                        .flag = &bchOpts.noErrp,
                         .flag_type = FLAG_TYPE_SET_TRUE,
                         .description = "Do not print errors."
                     },
                     {
                         .short_name = 'j',
                         .long_name = "json",
-                        .flag = &prtOpts.json,
+                        .flag = &bchOpts.json,
                         .flag_type = FLAG_TYPE_SET_TRUE,
                         .description = "Print output to JSON formatted data."
                     },
+                    {
+                        .short_name = 'i',
+                        .long_name = "iterations",
+                        .arg_name = "uint16",
+                        .arg_data_type = DATA_TYPE_UINT16,
+                        .arg_storage = &bchOpts.iterations,
+                        .description = "Times every image is encoded and decoded per case. (Default: 3)"
+                    },
+                    {
+                        .short_name = 'm',
+                        .long_name = "miplimit",
+                        .arg_name = "uint8",
+                        .arg_data_type = DATA_TYPE_UINT8,
+                        .arg_storage = &bchOpts.mipLimit,
+                        .description = "Maximum amount of mipmaps to encode for non indexed formats. 0 means as "
+                            "many as possible. (Default: 1)"
+                    },
+                    {
+                        .short_name = 't',
+                        .long_name = "texfmt",
+                        .arg_name = "string",
+                        .arg_data_type = DATA_TYPE_STR,
+                        .arg_storage = &bchOpts.texFmt,
+                        .description = "Only benchmark this texture format. Valid values: " TexList(", ")
+                    },
+                    {
+                        .short_name = 'q',
+                        .long_name = "quantize",
+                        .flag = &encOpts.quantize,
+                        .flag_type = FLAG_TYPE_SET_TRUE,
+                        .description = "Quantize indexed formats with txtrtool's own quantizer like encode's "
+                            "--quantize does."
+                    },
+                    {
+                        .short_name = 'c',
+                        .long_name = "concurrentmips",
+                        .flag = &encOpts.concurrentMips,
+                        .flag_type = FLAG_TYPE_SET_TRUE,
+                        .description = "Encode with encode's --concurrentmips."
+                    },
+                    {
+                        .short_name = 'T',
+                        .long_name = "threads",
+                        .arg_name = "uint16",
+                        .arg_data_type = DATA_TYPE_UINT16,
+                        .arg_storage = &encOpts.threads,
+                        .description = "Encode with this many threads like encode's --threads. (Default: 1)"
+                    },
+                    {
+                        .short_name = 'k',
+                        .long_name = "checkkernels",
+                        .flag = &bchOpts.checkKernels,
+                        .flag_type = FLAG_TYPE_SET_TRUE,
+                        .description = "Check the kernels of the instruction set in use against the baseline ones "
+                            "over every pixel value of every format txtrtool decodes itself (or only --texfmt) and "
+                            "exit without benchmarking. Takes no operands."
+                    },
+                    {
+                        .long_name = "directdecode",
+                        .flag = &bchOpts.directDecode,
+                        .flag_type = FLAG_TYPE_SET_TRUE,
+                        .description = "Decode like decode's --directdecode, checking the result against the txtr "
+                            "library's first."
+                    },
                     { END_OF_OPTIONS }
                 }
             },
@@ -1316,7 +4574,11 @@ int main(int argc, char **argv) {
         encOpts.squishMetricPtr = SQUISH_DEFAULT_METRIC;
     
     // if this isnt true, then the program should have already quit from an exit call before reaching here
-    assert(ttMode >= TTM_DECODE && ttMode <= TTM_PRINT);
+    assert(ttMode >= TTM_DECODE && ttMode <= TTM_THUMB);
+    
+    TTStatus_t sie = selectISA();
+    if (sie)
+        return sie;
     
     argc--;
     argv++;
@@ -1329,8 +4591,13 @@ int main(int argc, char **argv) {
         if (argc < 2 || !*(argv[0]) || !*(argv[1])) {
             eprintf("ERROR: At least two operands are required.\n");
             return TTS_ERROR;
-        } else
+        } else {
+            TTStatus_t dve = validateDecodeOptions(&decOpts);
+            if (dve)
+                return dve;
+            
             return decode(&decOpts, argv[0], argv[1]);
+        }
     }
 #endif
 #ifdef TXTRTOOL_INCLUDE_ENCODE
@@ -1338,105 +4605,104 @@ int main(int argc, char **argv) {
         if (argc < 2 || !*(argv[0]) || !*(argv[1])) {
             eprintf("ERROR: At least two operands are required.\n");
             return TTS_ERROR;
-        } else {
-            encOpts.texFmtDec = Str2Tex(encOpts.texFmt);
-            if (encOpts.texFmtDec == TXTR_TTF_INVALID) {
-                eprintf("ERROR: --texfmt: Invalid format \"%s\". Valid values: " TexList(", ") "\n", encOpts.texFmt);
-                return TTS_ERROR;
-            }
-            
-            encOpts.palFmtDec = Str2Pal(encOpts.palFmt);
-            if (encOpts.palFmtDec == TXTR_TPF_INVALID) {
-                eprintf("ERROR: --palfmt: Invalid format \"%s\". Valid values: " PalList(", ") "\n", encOpts.palFmt);
-                return TTS_ERROR;
-            }
-            
-            if (encOpts.mipLimit > 11) {
-                eprintf("ERROR: --miplimit: Limit %i must be less than 12.\n", encOpts.mipLimit);
-                return TTS_ERROR;
-            } else if (TXTR_IsIndexed(encOpts.texFmtDec) && encOpts.mipLimit > 1) {
-                eprintf("ERROR: --miplimit: Limit %i must be either 1 or 0 on indexed formats.\n", encOpts.mipLimit);
-                return TTS_ERROR;
-            }
-            if (!encOpts.mipLimit)
-                encOpts.mipLimit = !TXTR_IsIndexed(encOpts.texFmtDec) ? 11 : 1;
-            
-            if (!encOpts.widthLimit) {
-                eprintf("ERROR: --widthlimit: Limit %u must be greater than 0.\n", encOpts.widthLimit);
-                return TTS_ERROR;
-            }
-            // There is no way to check if its greater than image width at this point
-            
-            if (!encOpts.heightLimit) {
-                eprintf("ERROR: --heightlimit: Limit %u must be greater than 0.\n", encOpts.heightLimit);
-                return TTS_ERROR;
-            }
-            // There is no way to check if its greater than image height at this point
-            
-            encOpts.avgTypeDec = Str2AvgTyp(encOpts.avgType);
-            if (encOpts.avgTypeDec == GX_AT_INVALID) {
-                eprintf("ERROR: --avgtype: Invalid average type \"%s\". Valid values: " AvgTypList(", ") "\n",
-                    encOpts.avgType);
-                return TTS_ERROR;
-            }
+        } else if (argc > 2) {
+            // More operands than an output are extra outputs and their option overrides
+            TTEncodeTarget_t *targets;
+            size_t targetCount;
+            TTStatus_t pte = parseEncodeTargets(&encOpts, argc - 1, argv + 1, &targets, &targetCount);
+            if (pte)
+                return pte;
             
-            encOpts.stbirEdgeDec = Str2Edge(encOpts.stbirEdge);
-            if (encOpts.stbirEdgeDec < STBIR_EDGE_CLAMP || encOpts.stbirEdgeDec > STBIR_EDGE_ZERO) {
-                eprintf("ERROR: --stbiredge: Invalid edge mode \"%s\". Valid values: " EdgeList(", ") "\n",
-                    encOpts.stbirEdge);
-                return TTS_ERROR;
+            TTCache_t cache;
+            TTStatus_t oce = openEncodeCache(&encOpts, &cache);
+            if (oce) {
+                free(targets);
+                return oce;
             }
             
-            encOpts.stbirFilterDec = Str2Filter(encOpts.stbirFilter);
-            if (encOpts.stbirFilterDec < STBIR_FILTER_DEFAULT || encOpts.stbirFilterDec > STBIR_FILTER_POINT_SAMPLE) {
-                eprintf("ERROR: --stbirfilter: Invalid filter mode \"%s\". Valid values: " FilterList(", ") "\n",
-                    encOpts.stbirFilter);
-                return TTS_ERROR;
-            }
+            TTStatus_t ete = encodeTargets(&encOpts, argv[0], targets, targetCount);
+            closeEncodeCache(&encOpts);
+            free(targets);
+            return ete;
+        } else {
+            TTStatus_t eve = validateEncodeOptions(&encOpts);
+            if (eve)
+                return eve;
             
-            encOpts.ditherTypeDec = Str2DitherType(encOpts.ditherType);
-            if (encOpts.ditherTypeDec == GX_DT_INVALID) {
-                eprintf("ERROR: --dithertype: Invalid dither type \"%s\". Valid values: " DitherTypeList(", ") "\n",
-                    encOpts.ditherType);
-                return TTS_ERROR;
-            }
+            TTCache_t cache;
+            TTStatus_t oce = openEncodeCache(&encOpts, &cache);
+            if (oce)
+                return oce;
             
-            if (encOpts.squishMetricValid) {
-                if (encOpts.squishMetricSz != 3) {
-                    eprintf("ERROR: --squishmetric: Metric of size %zu must be 3.\n", encOpts.squishMetricSz);
-                    return TTS_ERROR;
-                } else {
-                    if (encOpts.squishMetricPtr[0] < 0.0f || encOpts.squishMetricPtr[0] > 1.0f) {
-                        eprintf("ERROR: --squishmetric: Metric's first component must be between 0.0 and 1.0.\n");
-                        return TTS_ERROR;
-                    }
-                    
-                    if (encOpts.squishMetricPtr[1] < 0.0f || encOpts.squishMetricPtr[1] > 1.0f) {
-                        eprintf("ERROR: --squishmetric: Metric's second component must be between 0.0 and 1.0.\n");
-                        return TTS_ERROR;
-                    }
-                    
-                    if (encOpts.squishMetricPtr[2] < 0.0f || encOpts.squishMetricPtr[2] > 1.0f) {
-                        eprintf("ERROR: --squishmetric: Metric's third component must be between 0.0 and 1.0.\n");
-                        return TTS_ERROR;
-                    }
-                }
-            }
+            TTStatus_t ee = encode(&encOpts, argv[0], argv[1]);
+            closeEncodeCache(&encOpts);
+            return ee;
+        }
+    }
+#endif
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+    if (ttMode == TTM_BATCHENCODE) {
+        if (argc < 2 || !*(argv[0]) || !*(argv[1])) {
+            eprintf("ERROR: At least two operands are required.\n");
+            return TTS_ERROR;
+        } else {
+            TTStatus_t eve = validateEncodeOptions(&encOpts);
+            if (eve)
+                return eve;
             
+            TTCache_t cache;
+            TTStatus_t oce = openEncodeCache(&encOpts, &cache);
+            if (oce)
+                return oce;
             
-            if (!!encOpts.squishAlphaWeight)
-                encOpts.squishFlags |= kWeightColourByAlpha;
-            if (!!encOpts.squishClusterFit)
-                encOpts.squishFlags |= kColourClusterFit;
-            if (!!encOpts.squishRangeFit)
-                encOpts.squishFlags |= kColourRangeFit;
-            if (!!encOpts.squishIterClusterFit)
-                encOpts.squishFlags |= kColourIterativeClusterFit;
+            TTStatus_t bee = batchEncode(&batOpts, &encOpts, argv[0], argv[1]);
+            closeEncodeCache(&encOpts);
+            return bee;
+        }
+    }
+#endif
+#ifdef TXTRTOOL_INCLUDE_DECODE
+    if (ttMode == TTM_BATCHDECODE) {
+        if (argc < 2 || !*(argv[0]) || !*(argv[1])) {
+            eprintf("ERROR: At least two operands are required.\n");
+            return TTS_ERROR;
+        } else {
+            TTStatus_t dve = validateDecodeOptions(&decOpts);
+            if (dve)
+                return dve;
             
-            return encode(&encOpts, argv[0], argv[1]);
+            return batchDecode(&batOpts, &decOpts, argv[0], argv[1]);
         }
     }
 #endif
+#ifdef TXTRTOOL_INCLUDE_DECODE
+    if (ttMode == TTM_THUMB) {
+        if (argc < 2 || !*(argv[0]) || !*(argv[1])) {
+            eprintf("ERROR: At least two operands are required.\n");
+            return TTS_ERROR;
+        } else if (!thmOpts.size) {
+            eprintf("ERROR: --size: Size %u must be greater than 0.\n", thmOpts.size);
+            return TTS_ERROR;
+        } else
+            return thumb(&thmOpts, argv[0], argv[1]);
+    }
+#endif
+#if defined(TXTRTOOL_INCLUDE_DECODE) || defined(TXTRTOOL_INCLUDE_ENCODE)
+    if (ttMode == TTM_SERVE) {
+        TTServer_t server = {
+            .opts = &srvOpts,
+#ifdef TXTRTOOL_INCLUDE_DECODE
+            .decOpts = &decOpts,
+#endif
+#ifdef TXTRTOOL_INCLUDE_ENCODE
+            .encOpts = &encOpts,
+#endif
+            .arenas = NULL,
+            .resizeCaches = NULL
+        };
+        return serve(&server);
+    }
+#endif
 #ifdef TXTRTOOL_INCLUDE_MISC
     if (ttMode == TTM_PRINT) {
         if (argc < 1 || !*(argv[0])) {
@@ -1446,6 +4712,21 @@ int main(int argc, char **argv) {
             return print(&prtOpts, argv[0]);
     }
 #endif
+#if defined(TXTRTOOL_INCLUDE_ENCODE) && defined(TXTRTOOL_INCLUDE_MISC)
+    if (ttMode == TTM_BENCH) {
+        if (!bchOpts.checkKernels && (argc < 1 || !*(argv[0]))) {
+            eprintf("ERROR: At least one operand is required.\n");
+            return TTS_ERROR;
+        } else {
+            // Settings bench doesn't sweep over keep encode's defaults
+            TTStatus_t eve = validateEncodeOptions(&encOpts);
+            if (eve)
+                return eve;
+            
+            return bench(&bchOpts, &encOpts, argc, argv);
+        }
+    }
+#endif
     
     // As stated in the previous assert, this should never be reached but it is here just in case
     eprintf("ERROR: Unknown command mode specified: %i.\n", ttMode);
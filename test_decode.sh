@@ -24,6 +24,21 @@ for F in `find "$indir" -maxdepth 1 -type f -name "*.TXTR"`; do
         test-start "\"$EXEC\" decode -my -a_ \"$F\" \"$outdir\""
         "$EXEC" decode -my -a_ "$F" "$outdir"
         test-end $?
+        
+        # The tool's own kernels (--directdecode) must give the same TGAs as the txtr library
+        name="$(basename "${F%.*}")"
+        mkdir -p "$outdir/library/$name" "$outdir/direct/$name"
+        test-start "\"$EXEC\" decode -my \"$F\" \"$outdir/library/$name\""
+        "$EXEC" decode -my "$F" "$outdir/library/$name"
+        test-end $?
+        
+        test-start "\"$EXEC\" decode -my --directdecode \"$F\" \"$outdir/direct/$name\""
+        "$EXEC" decode -my --directdecode "$F" "$outdir/direct/$name"
+        test-end $?
+        
+        test-start "diff -r \"$outdir/library/$name\" \"$outdir/direct/$name\""
+        diff -r "$outdir/library/$name" "$outdir/direct/$name"
+        test-end $?
     fi
 done
 [ -n "$OLDIFS" ] && IFS="$OLDIFS" || unset IFS
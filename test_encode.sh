@@ -16,6 +16,55 @@ function test-end {
     echo "________________________________________________________________________________"
 }
 
+# Encodes $1 with every mipmap as format $2 serially and with --concurrentmips (extra arguments go to both) and reports
+# whether both give the same bytes. They are not expected to (see --concurrentmips) so a difference is not an error.
+function test-concurrent {
+    infile="$1"
+    infilename="${1%.*}"
+    infilename="$(basename $infilename)"
+    outdir="$2"
+    fmt="$3"
+    shift 3
+    
+    test-start "\"$EXEC\" encode -y -t $fmt -m 0 $* \"$infile\" \"$outdir/${fmt}_serial_mips_${infilename}.TXTR\""
+    "$EXEC" encode -y -t $fmt -m 0 "$@" "$infile" "$outdir/${fmt}_serial_mips_${infilename}.TXTR"
+    test-end $?
+    
+    test-start "\"$EXEC\" encode -y -t $fmt -m 0 -c $* \"$infile\" \"$outdir/${fmt}_concurrent_mips_${infilename}.TXTR\""
+    "$EXEC" encode -y -t $fmt -m 0 -c "$@" "$infile" "$outdir/${fmt}_concurrent_mips_${infilename}.TXTR"
+    test-end $?
+    
+    test-start "cmp \"$outdir/${fmt}_serial_mips_${infilename}.TXTR\" \"$outdir/${fmt}_concurrent_mips_${infilename}.TXTR\""
+    if cmp -s "$outdir/${fmt}_serial_mips_${infilename}.TXTR" "$outdir/${fmt}_concurrent_mips_${infilename}.TXTR"; then
+        echo "Same bytes"
+    else
+        echo "Different bytes"
+    fi
+    test-end 0
+}
+
+# Encodes $1 as CMP with 1 thread and with 4 (extra arguments go to both) and checks that the bands compressed in
+# parallel give the same bytes.
+function test-bands {
+    infile="$1"
+    infilename="${1%.*}"
+    infilename="$(basename $infilename)"
+    outdir="$2"
+    shift 2
+    
+    test-start "\"$EXEC\" encode -y -t CMP -T 1 $* \"$infile\" \"$outdir/CMP_1thread_${infilename}.TXTR\""
+    "$EXEC" encode -y -t CMP -T 1 "$@" "$infile" "$outdir/CMP_1thread_${infilename}.TXTR"
+    test-end $?
+    
+    test-start "\"$EXEC\" encode -y -t CMP -T 4 $* \"$infile\" \"$outdir/CMP_4threads_${infilename}.TXTR\""
+    "$EXEC" encode -y -t CMP -T 4 "$@" "$infile" "$outdir/CMP_4threads_${infilename}.TXTR"
+    test-end $?
+    
+    test-start "cmp \"$outdir/CMP_1thread_${infilename}.TXTR\" \"$outdir/CMP_4threads_${infilename}.TXTR\""
+    cmp "$outdir/CMP_1thread_${infilename}.TXTR" "$outdir/CMP_4threads_${infilename}.TXTR"
+    test-end $?
+}
+
 function test-run {
     if [ -n "$1" ] && [ -f "$1" ] && [ -n "$2" ] && [ -d "$2" ] && [ -n "$3" ] ; then
         infile="$1"
@@ -370,41 +419,62 @@ function test-run {
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype THRESHOLD \"$infile\" \"$2/CI8_RGB5A3_THRESHOLD_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype THRESHOLD "$infile" "$2/CI8_RGB5A3_THRESHOLD_${infilename}.TXTR"
             test-end $?
-
+            
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype FLOYD_STEINBERG \"$infile\" \"$2/CI8_RGB5A3_FLOYD_STEINBERG_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype FLOYD_STEINBERG "$infile" "$2/CI8_RGB5A3_FLOYD_STEINBERG_${infilename}.TXTR"
             test-end $?
-
+            
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype ATKINSON \"$infile\" \"$2/CI8_RGB5A3_ATKINSON_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype ATKINSON "$infile" "$2/CI8_RGB5A3_ATKINSON_${infilename}.TXTR"
             test-end $?
-
+            
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype JARVIS_JUDICE_NINKE \"$infile\" \"$2/CI8_RGB5A3_JARVIS_JUDICE_NINKE_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype JARVIS_JUDICE_NINKE "$infile" "$2/CI8_RGB5A3_JARVIS_JUDICE_NINKE_${infilename}.TXTR"
             test-end $?
-
+            
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype STUCKI \"$infile\" \"$2/CI8_RGB5A3_STUCKI_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype STUCKI "$infile" "$2/CI8_RGB5A3_STUCKI_${infilename}.TXTR"
             test-end $?
-
+            
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype BURKES \"$infile\" \"$2/CI8_RGB5A3_BURKES_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype BURKES "$infile" "$2/CI8_RGB5A3_BURKES_${infilename}.TXTR"
             test-end $?
-
+            
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype TWO_ROW_SIERRA \"$infile\" \"$2/CI8_RGB5A3_TWO_ROW_SIERRA_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype TWO_ROW_SIERRA "$infile" "$2/CI8_RGB5A3_TWO_ROW_SIERRA_${infilename}.TXTR"
             test-end $?
-
+            
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype SIERRA \"$infile\" \"$2/CI8_RGB5A3_SIERRA_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype SIERRA "$infile" "$2/CI8_RGB5A3_SIERRA_${infilename}.TXTR"
             test-end $?
-
+            
             test-start "\"$EXEC\" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype SIERRA_LITE \"$infile\" \"$2/CI8_RGB5A3_SIERRA_LITE_${infilename}.TXTR\""
             "$EXEC" encode -y -t CI8 -p RGB5A3 -m 1 --dithertype SIERRA_LITE "$infile" "$2/CI8_RGB5A3_SIERRA_LITE_${infilename}.TXTR"
             test-end $?
         fi
         
-        # TODO: Mipmap tests
+        if [ "$3" == "all" ] || [ "$3" == "concurrent" ] ; then
+            # --concurrentmips resizes the levels in the tool instead of TXTR_Encode, this shows where the bytes differ
+            echo "Testing concurrent mipmaps..."
+            
+            test-concurrent "$infile" "$2" I4 --avgtype AVERAGE
+            test-concurrent "$infile" "$2" I8 --avgtype AVERAGE
+            test-concurrent "$infile" "$2" IA4 --avgtype AVERAGE
+            test-concurrent "$infile" "$2" IA8 --avgtype AVERAGE
+            test-concurrent "$infile" "$2" R5G6B5
+            test-concurrent "$infile" "$2" RGB5A3
+            test-concurrent "$infile" "$2" RGBA8
+            test-concurrent "$infile" "$2" CMP --squishrangefit
+        fi
+        
+        if [ "$3" == "all" ] || [ "$3" == "cmp" ] ; then
+            # CMP split into bands with --threads
+            echo "Testing CMP bands..."
+            
+            test-bands "$infile" "$2" -m 1 --squishrangefit
+            test-bands "$infile" "$2" -m 0 --squishrangefit
+            test-bands "$infile" "$2" -m 1 --squishclusterfit
+        fi
     fi
 }
 
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+dp0="$(dirname $(readlink -m $BASH_SOURCE))"
+
+EXEC="$dp0/build/txtrtool"
+[ "$(expr substr $(uname -s) 1 10)" == "MINGW32_NT" ] || [ "$(expr substr $(uname -s) 1 10)" == "MINGW64_NT" ] && EXEC="$EXEC.exe"
+
+function test-start {
+    echo "________________________________________________________________________________"
+    echo "$1"
+}
+
+function test-end {
+    if [ $1 -ne 0 ]; then echo "__________________ ERROR: returned non-zero status of $1  __________________" ; fi
+    echo "________________________________________________________________________________"
+}
+
+# Every instruction set's decode kernels against the baseline ones (--isa fails on the ones this CPU or build lacks)
+for ISA in baseline sse2 avx avx2; do
+    test-start "\"$EXEC\" --isa $ISA bench --checkkernels"
+    "$EXEC" --isa $ISA bench --checkkernels
+    test-end $?
+done